@@ -0,0 +1,151 @@
+/**************************************************************************************************
+Authours:				Craig Comberbach
+Target Hardware:		Linux host
+Chip resources used:	Timers_POSIX.c
+Code assumptions:		Built with "gcc -O2 -pthread -IFirmware Benchmarks/Timers_POSIX_Benchmark.c Firmware/Timers_POSIX.c -o timers_benchmark"
+Purpose:				Measure expiry latency and callback throughput of the POSIX timer backend against the number of running timers.
+						Every timer shares one function, which measures its lateness on CLOCK_MONOTONIC against the expiry it was scheduled for
+
+Version History:
+v0.1.2	2026-10-19  Craig Comberbach
+	*BUG FIX* Waits a period after stopping the timers so callbacks already running on the workers finish before the counters are read or reset
+	*BUG FIX* The counters are read and reset atomically
+v0.1.1	2026-10-19  Craig Comberbach
+	*BUG FIX* Latency is measured against the scheduled expiry, Current Timer wraps every period so a call more than one period late looked on time
+v0.1.0	2026-10-19  Craig Comberbach
+	First version
+**************************************************************************************************/
+/*************    Header Files    ***************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Timers.h"
+
+/************* Semantic Versioning***************/
+/************Arbitrary Functionality*************/
+/*************   Magic  Numbers   ***************/
+#define RUN_SECONDS			2
+#define PERIOD_US			10000	//Every timer expires every 10 mS
+#define LATENCY_BUCKETS		32		//Power of two buckets, bucket n holds latencies below 2^n nS
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions*************/
+/*************  Global Variables  ***************/
+unsigned long long expiries;
+unsigned long long totalLatency;
+unsigned long long worstLatency;
+unsigned long long latencyHistogram[LATENCY_BUCKETS];
+
+/*************Function  Prototypes***************/
+void Benchmark_Expiry(void);
+void Run_Benchmark(int numberOfTimers);
+unsigned long long Latency_Percentile(int percent);
+
+/************* Device Definitions ***************/
+/************* Module Definitions ***************/
+/************* Other  Definitions ***************/
+
+int main(int argc, char **argv)
+{
+	int numberOfTimers;
+
+	printf("%8s %12s %12s %10s %10s %10s %8s\n", "timers", "expected/s", "achieved/s", "mean uS", "p99 uS", "max uS", "dropped");
+	for(numberOfTimers = 16; numberOfTimers <= NUMBER_OF_AVAILABLE_TIMERS; numberOfTimers *= 4)
+		Run_Benchmark(numberOfTimers);
+
+	return 0;
+}
+
+void Run_Benchmark(int numberOfTimers)
+{
+	struct timespec runTime = {RUN_SECONDS, 0};
+	struct timespec settleTime = {0, PERIOD_US * 1000L};
+	unsigned long dropped = 0;
+	unsigned long long expired;
+	int timer;
+	int bucket;
+
+	//Start counting fresh, the last run has already waited for its callbacks to finish
+	__atomic_store_n(&expiries, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&totalLatency, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&worstLatency, 0, __ATOMIC_RELAXED);
+	for(bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+		__atomic_store_n(&latencyHistogram[bucket], 0, __ATOMIC_RELAXED);
+
+	for(timer = 0; timer < numberOfTimers; timer++)
+	{
+		Change_Timer_Overrun_Policy(timer, SKIP_MISSED_PERIODS);
+		if(Initialize_Timer(timer, PERIOD_US, MICRO_SECONDS, Benchmark_Expiry) == 0)
+		{
+			printf("Timer %d failed to initialize\n", timer);
+			exit(1);
+		}
+	}
+
+	nanosleep(&runTime, NULL);
+
+	for(timer = 0; timer < numberOfTimers; timer++)
+	{
+		Change_Timer_Trigger(timer, TIMER_OFF);
+		dropped += Timer_Dropped_Periods(timer);
+	}
+
+	//Turning a timer off does not wait for a call already running on a worker, give them a period to finish
+	nanosleep(&settleTime, NULL);
+
+	expired = __atomic_load_n(&expiries, __ATOMIC_RELAXED);
+	printf("%8d %12llu %12llu %10.1f %10.1f %10.1f %8lu\n",
+		numberOfTimers,
+		(unsigned long long)numberOfTimers * 1000000 / PERIOD_US,
+		expired / RUN_SECONDS,
+		expired ? __atomic_load_n(&totalLatency, __ATOMIC_RELAXED) / (double)expired / 1000 : 0.0,
+		Latency_Percentile(99) / 1000.0,
+		__atomic_load_n(&worstLatency, __ATOMIC_RELAXED) / 1000.0,
+		dropped);
+
+	return;
+}
+
+void Benchmark_Expiry(void)
+{
+	struct timespec now;
+	long long lateness;
+	unsigned long long latency;
+	unsigned long long worst;
+	int bucket = 0;
+
+	//Time since the expiry this call is serving, this does not wrap so calls more than a period late are seen
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	lateness = now.tv_sec * 1000000000LL + now.tv_nsec - Timer_Expiry_In_Service();
+	latency = (lateness > 0) ? (unsigned long long)lateness : 0;
+
+	while((bucket < LATENCY_BUCKETS - 1) && ((1ULL << bucket) <= latency))
+		bucket++;
+
+	__atomic_add_fetch(&expiries, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&totalLatency, latency, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&latencyHistogram[bucket], 1, __ATOMIC_RELAXED);
+	worst = __atomic_load_n(&worstLatency, __ATOMIC_RELAXED);
+	while((latency > worst) && !__atomic_compare_exchange_n(&worstLatency, &worst, latency, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	return;
+}
+
+unsigned long long Latency_Percentile(int percent)
+{
+	unsigned long long expired = __atomic_load_n(&expiries, __ATOMIC_RELAXED);
+	unsigned long long worst = __atomic_load_n(&worstLatency, __ATOMIC_RELAXED);
+	unsigned long long seen = 0;
+	int bucket;
+
+	//Report the upper edge of the bucket the percentile falls into
+	for(bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+	{
+		seen += __atomic_load_n(&latencyHistogram[bucket], __ATOMIC_RELAXED);
+		if(seen * 100 >= expired * percent)
+			return ((1ULL << bucket) < worst) ? (1ULL << bucket) : worst;
+	}
+
+	return worst;
+}
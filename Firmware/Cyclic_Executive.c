@@ -0,0 +1,205 @@
+/**************************************************************************************************
+Authours:				Craig Comberbach
+Target Hardware:		PIC24F
+Chip resources used:	One Timer (chosen at initialization)
+Code assumptions:		Every period is a whole number of uS
+Purpose:				Run several periodic rates off of a single hardware timer. The minor frame is the greatest common divisor of the rates and each
+						rate counts down its period in minor frames, worked out at start up, so no divides or modulos are done while dispatching
+
+Version History:
+v0.3.1	2026-10-19  Craig Comberbach
+	Cyclic_Executive.h defines its semantic version like every other header
+v0.3.0	2026-10-19  Craig Comberbach
+	Rates no longer have to be harmonic, each rate counts its own period in minor frames (20 mS and 30 mS run off of a 10 mS frame)
+	*BUG FIX* Periods in seconds that do not fit in uS are refused instead of wrapping
+v0.2.1	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer3 is refused, it has no period register so the minor frame would silently become its 16 bit rollover
+v0.2.0	2026-10-19  Craig Comberbach
+	Frame overruns are now counted by the timer driver, late frames are caught up so the slower rates stay in phase
+v0.1.0	2026-10-19  Craig Comberbach
+	Rates are registered, sorted fastest first and folded into a table of harmonic ratios
+	Minor frame is solved from the GCD of the periods and loaded into a single timer through Initialize_Timer
+	Frame overruns are detected by checking if the timer expired again while the frame was still running
+**************************************************************************************************/
+/*************    Header Files    ***************/
+#include "Config.h"
+#include "Cyclic_Executive.h"
+
+/************* Semantic Versioning***************/
+#if TIMERS_MAJOR != 0
+	#warning "Timers.c has had a change that loses some previously supported functionality"
+#elif TIMERS_MINOR != 6
+	#warning "Timers.c has new features that this code may benefit from"
+#elif TIMERS_PATCH != 8
+	#warning "Timers.c has had a bug fix, you should check to see that we weren't relying on a bug for functionality"
+#endif
+
+/************Arbitrary Functionality*************/
+/*************   Magic  Numbers   ***************/
+#define MAX_INT_TIME	32767	//Largest time that can be handed to Initialize_Timer, the driver converts it to nS in 64 bits so any unit is safe
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions*************/
+/*************  Global Variables  ***************/
+struct CYCLIC_RATE
+{
+	unsigned long period;				//Period in uS
+	void (*rateFunction)(void);			//Work to do every period
+	unsigned int framesPerCall;			//Minor frames between calls
+	unsigned int countdown;				//Minor frames remaining until the next call
+} cyclicRates[MAXIMUM_CYCLIC_RATES];
+
+int numberOfCyclicRates = 0;
+int cyclicExecutiveRunning = 0;
+enum TIMERS_AVAILABLE frameTimer;
+
+/*************Function  Prototypes***************/
+void Cyclic_Executive_Frame(void);
+unsigned long Greatest_Common_Divisor(unsigned long a, unsigned long b);
+
+/************* Device Definitions ***************/
+/************* Module Definitions ***************/
+/************* Other  Definitions ***************/
+
+int Register_Cyclic_Rate(int time, enum TIMER_UNITS units, void (*rateFunction)(void))
+{
+	unsigned long period;
+
+	//Range checking
+	if(cyclicExecutiveRunning)
+		return 0;//The frame table has already been built
+	if(numberOfCyclicRates >= MAXIMUM_CYCLIC_RATES)
+		return 0;//No room left in the table
+	if((time <= 0) || (rateFunction == (void *)0))
+		return 0;//Out of range
+
+	//Determine the period in uS
+	switch(units)
+	{
+		case SECONDS:
+			if((unsigned long)time > (0xFFFFFFFF / 1000000))
+				return 0;//Too long to hold in uS
+			period = (unsigned long)time * 1000000;//Change to the appropriate resolution
+			break;
+		case MILLI_SECONDS:
+			period = (unsigned long)time * 1000;//Change to the appropriate resolution
+			break;
+		case MICRO_SECONDS:
+			period = (unsigned long)time;//Change to the appropriate resolution
+			break;
+		case NANO_SECONDS:
+			if(time % 1000)
+				return 0;//Sub-microsecond periods are not supported
+			period = (unsigned long)(time / 1000);//Change to the appropriate resolution
+			break;
+		case TICKS://Tick length depends on the minor frame, which is not known yet
+		default:
+			return 0;//Invalid units
+	}
+
+	//Add it to the table
+	cyclicRates[numberOfCyclicRates].period = period;
+	cyclicRates[numberOfCyclicRates].rateFunction = rateFunction;
+	numberOfCyclicRates++;
+
+	//Success
+	return 1;
+}
+
+int Initialize_Cyclic_Executive(enum TIMERS_AVAILABLE timer)
+{
+	struct CYCLIC_RATE swap;
+	unsigned long minorFrame;
+	int rate;
+	int index;
+
+	//Range checking
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if(timer == TIMER3)
+		return 0;//Timer3 has no period register, it can only roll over
+	if(cyclicExecutiveRunning || (numberOfCyclicRates == 0))
+		return 0;//Already running or nothing to run
+
+	//Sort the rates fastest first (Insertion sort, the table is tiny)
+	for(rate = 1; rate < numberOfCyclicRates; rate++)
+	{
+		swap = cyclicRates[rate];
+		for(index = rate; (index > 0) && (cyclicRates[index - 1].period > swap.period); index--)
+			cyclicRates[index] = cyclicRates[index - 1];
+		cyclicRates[index] = swap;
+	}
+
+	//The minor frame is the GCD of all of the periods
+	minorFrame = cyclicRates[0].period;
+	for(rate = 1; rate < numberOfCyclicRates; rate++)
+		minorFrame = Greatest_Common_Divisor(minorFrame, cyclicRates[rate].period);
+
+	//Build the frame table - Each rate counts down its own period in minor frames
+	for(rate = 0; rate < numberOfCyclicRates; rate++)
+	{
+		if((cyclicRates[rate].period / minorFrame) > 0xFFFF)
+			return 0;//Too many minor frames to count
+		cyclicRates[rate].framesPerCall = cyclicRates[rate].period / minorFrame;
+	}
+
+	//Everything runs in the very first frame
+	for(rate = 0; rate < numberOfCyclicRates; rate++)
+		cyclicRates[rate].countdown = 1;
+
+	frameTimer = timer;
+	cyclicExecutiveRunning = 1;
+
+	//Load the minor frame into the timer, use the finest units that will fit
+	if(minorFrame <= MAX_INT_TIME)
+	{
+		if(Initialize_Timer(timer, (int)minorFrame, MICRO_SECONDS, Cyclic_Executive_Frame) == 1)
+			return Change_Timer_Overrun_Policy(timer, CATCH_UP_MISSED_PERIODS);//Late frames are still dispatched so the rates stay in phase
+	}
+	else if(((minorFrame % 1000) == 0) && ((minorFrame / 1000) <= MAX_INT_TIME))
+	{
+		if(Initialize_Timer(timer, (int)(minorFrame / 1000), MILLI_SECONDS, Cyclic_Executive_Frame) == 1)
+			return Change_Timer_Overrun_Policy(timer, CATCH_UP_MISSED_PERIODS);//Late frames are still dispatched so the rates stay in phase
+	}
+
+	//The timer could not produce the minor frame
+	cyclicExecutiveRunning = 0;
+	return 0;
+}
+
+unsigned long Cyclic_Executive_Overruns(void)
+{
+	return Timer_Overruns(frameTimer);
+}
+
+void Cyclic_Executive_Frame(void)
+{
+	int rate;
+
+	//Every rate that is due runs, fastest first
+	for(rate = 0; rate < numberOfCyclicRates; rate++)
+	{
+		if(--cyclicRates[rate].countdown != 0)
+			continue;
+		cyclicRates[rate].countdown = cyclicRates[rate].framesPerCall;
+		cyclicRates[rate].rateFunction();
+	}
+
+	//Return to where we left off
+	return;
+}
+
+unsigned long Greatest_Common_Divisor(unsigned long a, unsigned long b)
+{
+	unsigned long remainder;
+
+	//Euclid's algorithm, only used while building the frame table
+	while(b != 0)
+	{
+		remainder = a % b;
+		a = b;
+		b = remainder;
+	}
+
+	return a;
+}
@@ -0,0 +1,47 @@
+#ifndef CYCLIC_EXECUTIVE_H
+#define	CYCLIC_EXECUTIVE_H
+
+/*************    Header Files    ***************/
+#include "Timers.h"
+
+/************* Semantic Versioning***************/
+#define CYCLIC_EXECUTIVE_LIBRARY
+#define CYCLIC_EXECUTIVE_MAJOR	0
+#define CYCLIC_EXECUTIVE_MINOR	3
+#define CYCLIC_EXECUTIVE_PATCH	1
+
+/*************   Magic  Numbers   ***************/
+#define MAXIMUM_CYCLIC_RATES	8
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions************/
+/*************Function  Prototypes***************/
+/**
+ * Adds a periodic rate to the cyclic executive, this must be done before Initialize_Cyclic_Executive is called
+ * @param time The period of the rate
+ * @param units The units to use (S, mS, uS, nS). Use the enum TIMER_UNITS to correctly specify\
+ * TICKS are not accepted as the tick length is not known until the minor frame has been solved
+ * @param rateFunction The function that will be called every period, it should be a function pointer that has the format of "void Some_Function(void)"
+ * @return 1 = The rate has been added to the schedule\
+ * 0 = Something failed, either an argument sent was out of range, the table is full or the executive is already running
+ */
+int Register_Cyclic_Rate(int time, enum TIMER_UNITS units, void (*rateFunction)(void));
+
+/**
+ * Builds the frame table from the registered rates and starts the executive on a single hardware timer
+ * The minor frame is the greatest common divisor of the registered periods, each rate runs every period/minor frame frames\
+ * Rates do not have to be harmonic, but the further apart they are the smaller the minor frame and the more often the timer interrupts
+ * @param timer The hardware timer that will tick the minor frame, use the enum TIMERS_AVAILABLE. TIMER3 is refused as it has no period register
+ * @return 1 = The frame table was built and the timer has been properly initialized\
+ * 0 = Something failed, either no rates are registered, a rate needs more than 65535 minor frames or the minor frame could not be set on the timer
+ */
+int Initialize_Cyclic_Executive(enum TIMERS_AVAILABLE timer);
+
+/**
+ * Reports how many minor frames did not finish before the next minor frame was due
+ * Late frames are caught up (up to TIMER_CATCH_UP_LIMIT back to back) so the slower rates stay in phase
+ * @return The number of frame overruns since the executive was started, saturates at 0xFFFFFFFF
+ */
+unsigned long Cyclic_Executive_Overruns(void);
+
+#endif	/* CYCLIC_EXECUTIVE_H */
@@ -0,0 +1,130 @@
+/**************************************************************************************************
+Authours:				Craig Comberbach
+Target Hardware:		PIC24F
+Chip resources used:	None, time comes from a timestamp function supplied by the project
+Code assumptions:		The timestamp function is short, it is called with interrupts held off
+Purpose:				Token bucket rate limiting without a periodic interrupt per limiter. Each bucket is refilled lazily from the ticks that
+						have elapsed since it was last used. Tokens are kept in ticks, so taking one is only a subtraction and a compare
+
+Version History:
+v0.1.1	2026-10-19  Craig Comberbach
+	HIGHEST_IPL comes from Timers.h instead of a private copy
+v0.1.0	2026-10-19  Craig Comberbach
+	Token buckets are refilled on demand from a single timestamp source
+	Rate Limiter Consume is O(1), divide free and safe to call from interrupts
+**************************************************************************************************/
+/*************    Header Files    ***************/
+#include "Config.h"
+#include "Rate_Limiter.h"
+#include "Timers.h"
+
+/************* Semantic Versioning***************/
+#if TIMERS_MAJOR != 0
+	#warning "Timers.c has had a change that loses some previously supported functionality"
+#elif TIMERS_MINOR != 6
+	#warning "Timers.c has new features that this code may benefit from"
+#elif TIMERS_PATCH != 8
+	#warning "Timers.c has had a bug fix, you should check to see that we weren't relying on a bug for functionality"
+#endif
+
+/************Arbitrary Functionality*************/
+/*************   Magic  Numbers   ***************/
+/*************    Enumeration     ***************/
+/***********State Machine Definitions*************/
+/*************  Global Variables  ***************/
+struct TOKEN_BUCKET
+{
+	unsigned long credit;			//Saved up tokens, in ticks
+	unsigned long capacity;			//Burst size, in ticks
+	unsigned long ticksPerToken;	//Cost of one token, 0 = limiter not setup
+	unsigned long lastTimestamp;	//When the bucket was last refilled
+} tokenBuckets[MAXIMUM_RATE_LIMITERS];
+
+unsigned long (*Rate_Limiter_Timestamp)(void) = (void *)0;
+
+/*************Function  Prototypes***************/
+/************* Device Definitions ***************/
+/************* Module Definitions ***************/
+/************* Other  Definitions ***************/
+
+int Initialize_Rate_Limiter_Timestamp(unsigned long (*timestampFunction)(void))
+{
+	//Range checking
+	if(timestampFunction == (void *)0)
+		return 0;//Null pointer
+
+	Rate_Limiter_Timestamp = timestampFunction;
+
+	//Success
+	return 1;
+}
+
+int Initialize_Rate_Limiter(int limiter, unsigned long ticksPerToken, unsigned int burst)
+{
+	int oldIPL;
+
+	//Range checking
+	if((limiter < 0) || (limiter >= MAXIMUM_RATE_LIMITERS))
+		return 0;//Out of range
+	if((ticksPerToken == 0) || (burst == 0))
+		return 0;//Out of range
+	if(ticksPerToken > (0xFFFFFFFF / burst))
+		return 0;//Burst is too large to hold in ticks
+	if(Rate_Limiter_Timestamp == (void *)0)
+		return 0;//Nowhere to get the time from
+
+	//Hold off interrupts so a limiter in use is never seen half setup
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+
+	tokenBuckets[limiter].capacity		= ticksPerToken * burst;
+	tokenBuckets[limiter].credit		= tokenBuckets[limiter].capacity;//Start out full
+	tokenBuckets[limiter].ticksPerToken	= ticksPerToken;
+	tokenBuckets[limiter].lastTimestamp	= Rate_Limiter_Timestamp();
+
+	SRbits.IPL = oldIPL;
+
+	//Success
+	return 1;
+}
+
+int Rate_Limiter_Consume(int limiter)
+{
+	struct TOKEN_BUCKET *bucket;
+	unsigned long now;
+	unsigned long elapsed;
+	int oldIPL;
+	int allowed = 0;
+
+	//Range checking
+	if((limiter < 0) || (limiter >= MAXIMUM_RATE_LIMITERS))
+		return 0;//Out of range
+	bucket = &tokenBuckets[limiter];
+
+	//Hold off interrupts, the timestamp has to be read in the same critical section or an interrupt could make time go backwards for this bucket
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+
+	if(bucket->ticksPerToken)
+	{
+		//Refill from the time that has passed, unsigned subtraction takes care of the timestamp wrapping
+		now = Rate_Limiter_Timestamp();
+		elapsed = now - bucket->lastTimestamp;
+		bucket->lastTimestamp = now;
+		if(elapsed >= (bucket->capacity - bucket->credit))
+			bucket->credit = bucket->capacity;//Full
+		else
+			bucket->credit += elapsed;
+
+		//Take a token if there is one
+		if(bucket->credit >= bucket->ticksPerToken)
+		{
+			bucket->credit -= bucket->ticksPerToken;
+			allowed = 1;
+		}
+	}
+
+	SRbits.IPL = oldIPL;
+
+	return allowed;
+}
@@ -0,0 +1,44 @@
+#ifndef RATE_LIMITER_H
+#define	RATE_LIMITER_H
+
+/************* Semantic Versioning***************/
+#define RATE_LIMITER_LIBRARY
+#define RATE_LIMITER_MAJOR	0
+#define RATE_LIMITER_MINOR	1
+#define RATE_LIMITER_PATCH	1
+
+/*************   Magic  Numbers   ***************/
+#define MAXIMUM_RATE_LIMITERS	8
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions************/
+/*************Function  Prototypes***************/
+/**
+ * Sets where every rate limiter gets the time from, this must be done before any limiter is initialized
+ * @param timestampFunction A free running tick counter, it should be a function pointer that has the format of "unsigned long Some_Function(void)"\
+ * It is allowed to wrap, as long as no limiter goes unused for a full 2^32 ticks
+ * @return 1 = The timestamp source was accepted\
+ * 0 = A null pointer was sent
+ */
+int Initialize_Rate_Limiter_Timestamp(unsigned long (*timestampFunction)(void));
+
+/**
+ * Sets up a token bucket, it starts out full
+ * @param limiter Which limiter to setup, 0 to MAXIMUM_RATE_LIMITERS - 1
+ * @param ticksPerToken How many timestamp ticks it takes to earn one token
+ * @param burst The most tokens that can be saved up
+ * @return 1 = The limiter is ready to use\
+ * 0 = Something failed, either an argument sent was out of range or there is no timestamp source
+ */
+int Initialize_Rate_Limiter(int limiter, unsigned long ticksPerToken, unsigned int burst);
+
+/**
+ * Takes one token from the limiter if one is available, the bucket is refilled from the time elapsed since it was last used
+ * Safe to call from both the main loop and interrupts
+ * @param limiter Which limiter to take from, 0 to MAXIMUM_RATE_LIMITERS - 1
+ * @return 1 = A token was taken, go ahead\
+ * 0 = The bucket is empty (or the limiter is out of range/not setup), hold off
+ */
+int Rate_Limiter_Consume(int limiter);
+
+#endif	/* RATE_LIMITER_H */
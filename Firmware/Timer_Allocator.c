@@ -0,0 +1,314 @@
+/**************************************************************************************************
+Authours:				Craig Comberbach
+Target Hardware:		PIC24F
+Chip resources used:	Every timer that is handed out, plus one timer if software multiplexing is reserved
+Code assumptions:		Timer1 is running from the instruction clock when it is allocated
+Purpose:				Hand out hardware timers by what a job needs instead of by name. Each timer's prescaler, postscaler and period
+						register are compared against the requested period range and resolution and the least capable timer that fits wins.
+						Once the hardware runs out, jobs are multiplexed onto a reserved timer as software timers
+
+Version History:
+v0.1.1	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer2/4 reach is solved from the instruction clock with a full period of 0x100 counts, matching Timers.c v0.6.8
+	Timer_Allocator.h defines its semantic version like every other header
+v0.1.0	2026-10-19  Craig Comberbach
+	Best fit allocation across Timers 1/2/3/4 by period range and resolution
+	Software timers are counted down off of a single reserved timer when no hardware timer is free
+**************************************************************************************************/
+/*************    Header Files    ***************/
+#include "Config.h"
+#include "Timer_Allocator.h"
+
+/************* Semantic Versioning***************/
+#if TIMERS_MAJOR != 0
+	#warning "Timers.c has had a change that loses some previously supported functionality"
+#elif TIMERS_MINOR != 6
+	#warning "Timers.c has new features that this code may benefit from"
+#elif TIMERS_PATCH != 8
+	#warning "Timers.c has had a bug fix, you should check to see that we weren't relying on a bug for functionality"
+#endif
+
+/************Arbitrary Functionality*************/
+/*************   Magic  Numbers   ***************/
+#define NO_MULTIPLEX_TIMER	-1
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions*************/
+/*************  Global Variables  ***************/
+int hardwareAllocated[NUMBER_OF_AVAILABLE_TIMERS];
+
+struct SOFTWARE_TIMER
+{
+	int allocated;
+	unsigned int reload;				//Ticks per period
+	unsigned int countdown;				//Ticks until the next call
+	void (*interruptFunction)(void);	//Null until the timer is started
+} softwareTimers[MAXIMUM_SOFTWARE_TIMERS];
+
+int multiplexTimer = NO_MULTIPLEX_TIMER;
+int multiplexTickTime;
+enum TIMER_UNITS multiplexTickUnits;
+unsigned long long multiplexTickNS;
+int multiplexRunning = 0;
+
+/*************Function  Prototypes***************/
+unsigned long long Hardware_Reach(int timer, unsigned long shortestPeriod, unsigned long longestPeriod, unsigned long resolution);
+void Software_Timer_Tick(void);
+unsigned long long Time_To_NS(int time, enum TIMER_UNITS units);
+
+/************* Device Definitions ***************/
+/************* Module Definitions ***************/
+/************* Other  Definitions ***************/
+
+int Initialize_Timer_Allocator(enum TIMERS_AVAILABLE timer, int tickTime, enum TIMER_UNITS units)
+{
+	//Range checking
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if(hardwareAllocated[timer] || (multiplexTimer != NO_MULTIPLEX_TIMER))
+		return 0;//Already in use
+	if(Time_To_NS(tickTime, units) == 0)
+		return 0;//Out of range
+
+	//Hold on to it, it is started with the first software timer
+	hardwareAllocated[timer] = 1;
+	multiplexTimer = timer;
+	multiplexTickTime = tickTime;
+	multiplexTickUnits = units;
+	multiplexTickNS = Time_To_NS(tickTime, units);
+
+	//Success
+	return 1;
+}
+
+int Allocate_Timer(unsigned long shortestPeriod, unsigned long longestPeriod, unsigned long resolution)
+{
+	unsigned long long reach;
+	unsigned long long bestReach = 0;
+	int bestTimer = NO_TIMER_AVAILABLE;
+	int timer;
+	int slot;
+
+	//Range checking
+	if((shortestPeriod == 0) || (shortestPeriod > longestPeriod) || (resolution == 0))
+		return NO_TIMER_AVAILABLE;//Out of range
+
+	//Best fit - Of the free timers that can do the job, take the one with the least reach
+	for(timer = 0; timer < NUMBER_OF_AVAILABLE_TIMERS; timer++)
+	{
+		if(hardwareAllocated[timer])
+			continue;
+		reach = Hardware_Reach(timer, shortestPeriod, longestPeriod, resolution);
+		if(reach && ((bestTimer == NO_TIMER_AVAILABLE) || (reach < bestReach)))
+		{
+			bestTimer = timer;
+			bestReach = reach;
+		}
+	}
+	if(bestTimer != NO_TIMER_AVAILABLE)
+	{
+		hardwareAllocated[bestTimer] = 1;
+		return bestTimer;
+	}
+
+	//Fall back to multiplexing a software timer, if one was reserved and the tick is fine enough
+	if(multiplexTimer == NO_MULTIPLEX_TIMER)
+		return NO_TIMER_AVAILABLE;//No fallback
+	if((shortestPeriod < multiplexTickNS) || (resolution < multiplexTickNS) || ((longestPeriod / multiplexTickNS) > 0xFFFF))
+		return NO_TIMER_AVAILABLE;//Out of range for a software timer
+	for(slot = 0; slot < MAXIMUM_SOFTWARE_TIMERS; slot++)
+	{
+		if(!softwareTimers[slot].allocated)
+		{
+			softwareTimers[slot].allocated = 1;
+			softwareTimers[slot].interruptFunction = (void *)0;
+			return NUMBER_OF_AVAILABLE_TIMERS + slot;//Software handles follow the hardware ones
+		}
+	}
+
+	//Everything is taken
+	return NO_TIMER_AVAILABLE;
+}
+
+int Start_Allocated_Timer(int handle, int time, enum TIMER_UNITS units, void (*interruptFunction)(void))
+{
+	struct SOFTWARE_TIMER *softwareTimer;
+	unsigned long long ticks;
+	int oldIPL;
+
+	//Hardware timers are handed straight to the driver
+	if((handle >= 0) && (handle < NUMBER_OF_AVAILABLE_TIMERS))
+	{
+		if(!hardwareAllocated[handle] || (handle == multiplexTimer))
+			return 0;//Not allocated
+		return Initialize_Timer(handle, time, units, interruptFunction);
+	}
+
+	//Range checking
+	if((handle < NUMBER_OF_AVAILABLE_TIMERS) || (handle >= NUMBER_OF_AVAILABLE_TIMERS + MAXIMUM_SOFTWARE_TIMERS))
+		return 0;//Out of range
+	softwareTimer = &softwareTimers[handle - NUMBER_OF_AVAILABLE_TIMERS];
+	if(!softwareTimer->allocated || (interruptFunction == (void *)0))
+		return 0;//Not allocated or nothing to run
+
+	//Round to the nearest whole tick
+	ticks = Time_To_NS(time, units);
+	ticks += multiplexTickNS / 2;
+	ticks /= multiplexTickNS;
+	if((ticks == 0) || (ticks > 0xFFFF))
+		return 0;//Out of range
+
+	//The tick interrupt must not see a half setup timer
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+	softwareTimer->reload = ticks;
+	softwareTimer->countdown = ticks;
+	softwareTimer->interruptFunction = interruptFunction;
+	SRbits.IPL = oldIPL;
+
+	//Start the tick the first time it is needed
+	if(!multiplexRunning)
+	{
+		if(Initialize_Timer(multiplexTimer, multiplexTickTime, multiplexTickUnits, Software_Timer_Tick) == 0)
+		{
+			softwareTimer->interruptFunction = (void *)0;
+			return 0;//The tick could not be made
+		}
+		multiplexRunning = 1;
+	}
+
+	//Success
+	return 1;
+}
+
+int Release_Timer(int handle)
+{
+	int slot;
+
+	//Hardware timers are stopped and handed back
+	if((handle >= 0) && (handle < NUMBER_OF_AVAILABLE_TIMERS))
+	{
+		if(!hardwareAllocated[handle] || (handle == multiplexTimer))
+			return 0;//Not allocated
+		Change_Timer_Trigger(handle, TIMER_OFF);
+		hardwareAllocated[handle] = 0;
+		return 1;//Success
+	}
+
+	//Range checking
+	if((handle < NUMBER_OF_AVAILABLE_TIMERS) || (handle >= NUMBER_OF_AVAILABLE_TIMERS + MAXIMUM_SOFTWARE_TIMERS))
+		return 0;//Out of range
+	if(!softwareTimers[handle - NUMBER_OF_AVAILABLE_TIMERS].allocated)
+		return 0;//Not allocated
+
+	//Clearing the function stops the tick from calling it
+	softwareTimers[handle - NUMBER_OF_AVAILABLE_TIMERS].interruptFunction = (void *)0;
+	softwareTimers[handle - NUMBER_OF_AVAILABLE_TIMERS].allocated = 0;
+
+	//Stop ticking once nothing is left to multiplex
+	for(slot = 0; slot < MAXIMUM_SOFTWARE_TIMERS; slot++)
+		if(softwareTimers[slot].allocated)
+			return 1;//Success
+	if(multiplexRunning)
+	{
+		Change_Timer_Trigger(multiplexTimer, TIMER_OFF);
+		multiplexRunning = 0;
+	}
+
+	//Success
+	return 1;
+}
+
+unsigned long long Hardware_Reach(int timer, unsigned long shortestPeriod, unsigned long longestPeriod, unsigned long resolution)
+{
+	unsigned long long needed;
+	unsigned long long divider;
+	int prescale;
+
+	//Returns the longest period the timer can make if it can do the job, 0 if it can not
+	switch(timer)
+	{
+		case 0://Timer1 - 16 bit period register, prescaler of 1:1, 1:8, 1:64 or 1:256
+			if(shortestPeriod < MIN_PERIOD_NS)
+				return 0;//Shorter than a single tick
+			for(prescale = 0; prescale < 4; prescale++)
+				if(longestPeriod <= 0xFFFFULL * timer1Prescale[prescale] * MIN_PERIOD_NS)
+					break;//Finest prescaler that still reaches
+			if((prescale == 4) || (((unsigned long long)timer1Prescale[prescale] * MIN_PERIOD_NS) > resolution))
+				return 0;//Can not reach, or too coarse once it does
+			return 0xFFFFULL * 256 * MIN_PERIOD_NS;
+		case 1://Timer2 - 8 bit period register, prescaler of 1:1, 1:4 or 1:16 and a postscaler of 1:1 to 1:16
+		case 3://Timer4 - Same as Timer2
+			#if defined __PIC24F08KL200__
+				if(timer == 3)
+					return 0;//Timer4 does not exist on this chip
+			#endif
+			if(((unsigned long long)shortestPeriod * (FOSC_HZ / 2) + 500000000ULL) / 1000000000ULL == 0)
+				return 0;//Shorter than a single tick
+			needed = ((unsigned long long)longestPeriod * (FOSC_HZ / 2) + 500000000ULL) / 1000000000ULL;	//Ticks, solved the same way as Timers.c
+			needed = (needed + 0x100 - 1) / 0x100;//Smallest combined divider that reaches, a maxed out period register counts 0x100
+			if(needed <= 16)
+				divider = needed ? needed : 1;//Postscaler alone
+			else if(needed <= 64)
+				divider = (needed + 3) & ~3ULL;//1:4 prescaler times the postscaler
+			else if(needed <= 256)
+				divider = (needed + 15) & ~15ULL;//1:16 prescaler times the postscaler
+			else
+				return 0;//Can not reach
+			if((divider * MIN_PERIOD_NS) > resolution)
+				return 0;//Too coarse
+			return 0xFFULL * 256 * MIN_PERIOD_NS;
+		case 2://Timer3 - No period register, it rolls over after 0x10000 counts with a prescaler of 1:1, 1:2, 1:4 or 1:8
+			if((longestPeriod - shortestPeriod) > resolution)
+				return 0;//Its period can not be adjusted, so the job has to be happy with a single period
+			for(divider = 1; divider <= 8; divider *= 2)
+				if(((0x10000ULL * divider * MIN_PERIOD_NS) >= shortestPeriod) && ((0x10000ULL * divider * MIN_PERIOD_NS) <= longestPeriod))
+					return 0x10000ULL * 8 * MIN_PERIOD_NS;//One of its fixed periods is in range
+			return 0;//None of its fixed periods fit
+		default:
+			return 0;//Invalid Timer
+	}
+}
+
+void Software_Timer_Tick(void)
+{
+	int slot;
+
+	//Count every running software timer down, a tick costs a decrement per timer and no divides
+	for(slot = 0; slot < MAXIMUM_SOFTWARE_TIMERS; slot++)
+	{
+		if(softwareTimers[slot].interruptFunction == (void *)0)
+			continue;
+		if(--softwareTimers[slot].countdown == 0)
+		{
+			softwareTimers[slot].countdown = softwareTimers[slot].reload;
+			softwareTimers[slot].interruptFunction();
+		}
+	}
+
+	//Return to where we left off
+	return;
+}
+
+unsigned long long Time_To_NS(int time, enum TIMER_UNITS units)
+{
+	//Range checking
+	if(time <= 0)
+		return 0;//Out of range
+
+	//Determine the time in nS
+	switch(units)
+	{
+		case SECONDS:
+			return (unsigned long long)time * 1000000000;//Change to the appropriate resolution
+		case MILLI_SECONDS:
+			return (unsigned long long)time * 1000000;//Change to the appropriate resolution
+		case MICRO_SECONDS:
+			return (unsigned long long)time * 1000;//Change to the appropriate resolution
+		case NANO_SECONDS:
+			return (unsigned long long)time;//Change to the appropriate resolution
+		case TICKS://A tick depends on the timer
+		default:
+			return 0;//Invalid units
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef TIMER_ALLOCATOR_H
+#define	TIMER_ALLOCATOR_H
+
+/*************    Header Files    ***************/
+#include "Timers.h"
+
+/************* Semantic Versioning***************/
+#define TIMER_ALLOCATOR_LIBRARY
+#define TIMER_ALLOCATOR_MAJOR	0
+#define TIMER_ALLOCATOR_MINOR	1
+#define TIMER_ALLOCATOR_PATCH	1
+
+/*************   Magic  Numbers   ***************/
+#define NO_TIMER_AVAILABLE		-1
+#define MAXIMUM_SOFTWARE_TIMERS	8
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions************/
+/*************Function  Prototypes***************/
+/**
+ * Reserves one hardware timer as the tick for software timers, which are handed out once every other hardware timer is taken
+ * Calling this is optional, without it Allocate_Timer simply fails when the hardware runs out
+ * The reserved timer is not started until the first software timer is
+ * @param timer The timer to reserve, use the enum TIMERS_AVAILABLE
+ * @param tickTime The length of one software tick, this is the finest resolution a software timer can have
+ * @param units The units to use (S, mS, uS, nS). Use the enum TIMER_UNITS to correctly specify
+ * @return 1 = The timer has been reserved\
+ * 0 = Something failed, either an argument sent was out of range or the timer is already allocated
+ */
+int Initialize_Timer_Allocator(enum TIMERS_AVAILABLE timer, int tickTime, enum TIMER_UNITS units);
+
+/**
+ * Finds the free timer that best fits the job. Of the hardware timers that can reach the whole range at the requested
+ * resolution, the one with the least reach is picked so the more capable timers are left for the jobs that need them
+ * @param shortestPeriod The shortest period the job will ask for, in nS
+ * @param longestPeriod The longest period the job will ask for, in nS
+ * @param resolution The coarsest step in period the job can live with, in nS
+ * @return The handle to use with Start_Allocated_Timer and Release_Timer\
+ * NO_TIMER_AVAILABLE = Nothing free can do the job, or the arguments were out of range
+ */
+int Allocate_Timer(unsigned long shortestPeriod, unsigned long longestPeriod, unsigned long resolution);
+
+/**
+ * Starts an allocated timer, this takes the place of Initialize_Timer
+ * @param handle The handle returned by Allocate_Timer
+ * @param time The length of time it takes the timer to expire
+ * @param units The units to use (S, mS, uS, nS). Use the enum TIMER_UNITS to correctly specify
+ * @param interruptFunction The function that will be called when the timer expires, it should be a function pointer that has the format of "void Some_Function(void)"
+ * @return 1 = The timer has been started\
+ * 0 = Something failed, either the handle is not allocated or the time is out of range for the timer
+ */
+int Start_Allocated_Timer(int handle, int time, enum TIMER_UNITS units, void (*interruptFunction)(void));
+
+/**
+ * Stops an allocated timer and returns it to the pool
+ * @param handle The handle returned by Allocate_Timer
+ * @return 1 = The timer has been released\
+ * 0 = The handle was not allocated
+ */
+int Release_Timer(int handle);
+
+#endif	/* TIMER_ALLOCATOR_H */
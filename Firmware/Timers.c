@@ -6,6 +6,46 @@ Code assumptions:
 Purpose:				Allow access and control over the available timers. This includes handling intialization, temporary disabling/reenabling, interrupt control, and any other functionality
 
 Version History:
+v0.6.8	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer2/4 write one less than the ticks to the period register and solve from the instruction clock, v0.6.1 left every period one tick long and solved from the truncated MIN_PERIOD_NS
+v0.6.7	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer3 only accepts the exact rollover period of one of its prescalers, the old search narrowed the time into an int and was off by one count
+v0.6.6	2026-10-19  Craig Comberbach
+	*BUG FIX* Current Timer works out Timer1 in 64 bit nS, a long overflowed on the SOSC with a 1:8 or larger prescaler
+v0.6.5	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer1 period register is loaded with one less than the ticks in a period, the timer counts 0 to PR1 so PR1 + 1 ticks make a period
+v0.6.4	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer1 Uptime counts every match the interrupt clears, a Timer1 function that overran used to lose a period of uptime
+v0.6.3	2026-10-19  Craig Comberbach
+	*BUG FIX* Change Timer Time works in 64 bit nS, a long wrapped above 2147 mS (5 S came out as about 0.7 S)
+	*BUG FIX* Change Timer Time refuses times of zero or less
+v0.6.2	2026-10-19  Craig Comberbach
+	*BUG FIX* Change Timer Overrun Policy holds off interrupts while it clears the counts, the same as the reads
+v0.6.1	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer2/4 write the prescaler, the postscaler is written 0 based and the period is worked out without overflowing an int
+	MIN_PERIOD_NS, HIGHEST_IPL and the Timer1 prescaler table are shared through Timers.h
+v0.6.0	2026-10-19  Craig Comberbach
+	Added Initialize Timer1 SOSC function, the crystal is started once and watched on Timer1 until it has run for the oscillator start-up time
+	*BUG FIX* Change Timer1 Clock solves the new timebase from the period that was asked for, not the period rounded to the old tick
+	*BUG FIX* Change Timer1 Clock only stops Timer1 for a short fixed run of code, that time and any expiry pending at the handoff are added to the uptime
+v0.5.3	2026-10-19  Craig Comberbach
+	*BUG FIX* Change Timer Time converts to nS in a long, the int multiply overflowed on 16 bit compilers (1000 uS came out as roughly 17 uS)
+v0.5.2	2026-10-19  Craig Comberbach
+	*BUG FIX* Timer Overruns and Timer Dropped Periods hold off interrupts while reading, the counts are two words and could tear on a 16 bit core
+	*BUG FIX* TIMERS_MAJOR, TIMERS_MINOR and TIMERS_PATCH are now defined in Timers.h so the version checks work
+v0.5.1	2026-10-19  Craig Comberbach
+	*BUG FIX* Change Timer Time no longer calls itself forever when setting up Timer3
+	*BUG FIX* Timer3 prescaler is now chosen against a full 16 bit rollover instead of a single tick
+v0.5.0	2026-10-19  Craig Comberbach
+	Added Change Timer1 Clock function to hand Timer1 off between the instruction clock and the secondary oscillator without losing time
+	Added Sleep Until Timer1 function so the core can Sleep with Timer1 still keeping time off of the SOSC
+	Added Timer1 Uptime function, time accumulated across every handoff
+	Timer1 period solver now works from the clock frequency, so it handles either tick period and uses the full 16 bit PR1
+	Timer1 interrupt is always enabled so the uptime is kept, even when no function is sent
+v0.4.0	2026-10-19  Craig Comberbach
+	Interrupt flags are now cleared by the driver before the associated function is run
+	Added overrun detection, a timer that expires again while its function is still running is counted
+	Added Change Timer Overrun Policy function to choose if missed periods are skipped, coalesced into the next call or caught up
 v0.3.0	2013-08-29  Craig Comberbach
 	Compiler: C30 v3.31	IDE: MPLABx 1.80	Tool: RealICE	Computer: Intel Xeon CPU 3.07 GHz, 6 GB RAM, Windows 7 64 bit Professional SP1
  	Added Change Timer Trigger function to allow the timer to be enabled/disabled on the fly
@@ -32,19 +72,27 @@ v0.0.0	2013-07-20  Craig Comberbach
 /*************    Header Files    ***************/
 #include "Config.h"
 #include "Timers.h"
+#if defined __PIC24F08KL200__
+	#include <libpic30.h>	//__delay32, used while waiting on the SOSC crystal
+#endif
 
 /************* Semantic Versioning***************/
 #if TIMERS_MAJOR != 0
 	#warning "Timers.c has had a change that loses some previously supported functionality"
-#elif TIMERS_MINOR != 3
+#elif TIMERS_MINOR != 6
 	#warning "Timers.c has new features that this code may benefit from"
-#elif TIMERS_PATCH != 0
+#elif TIMERS_PATCH != 8
 	#warning "Timers.c has had a bug fix, you should check to see that we weren't relying on a bug for functionality"
 #endif
 
 /************Arbitrary Functionality*************/
 /*************   Magic  Numbers   ***************/
-#define MIN_PERIOD_NS (1000000000/(FOSC_HZ/2))	//Period of the instruction clock pulse in nanoseconds
+#ifndef SOSC_HZ
+	#define SOSC_HZ	32768						//Secondary oscillator crystal, define in Config.h if a different crystal is fitted
+#endif
+#define SOSC_STARTUP_TICKS	1024					//SOSC cycles to count before trusting the crystal, the same wait the oscillator start-up timer uses
+#define SOSC_STARTUP_MS		2000					//Give up on the crystal if it has not counted SOSC_STARTUP_TICKS by now
+#define TIMER1_HANDOFF_CYCLES	40					//Instruction cycles Timer1 is stopped for in Change_Timer1_Clock, recount from the disassembly if that code changes
 
 /*************    Enumeration     ***************/
 /***********State Machine Definitions*************/
@@ -53,12 +101,32 @@ void (*TMR1_interruptFunction)(void) = (void *)0;
 void (*TMR2_interruptFunction)(void) = (void *)0;
 void (*TMR3_interruptFunction)(void) = (void *)0;
 void (*TMR4_interruptFunction)(void) = (void *)0;
+enum TIMER_OVERRUN_POLICY overrunPolicy[NUMBER_OF_AVAILABLE_TIMERS];	//Defaults to SKIP_MISSED_PERIODS
+unsigned long overrunCount[NUMBER_OF_AVAILABLE_TIMERS];				//Expiries that happened while the function was still running
+unsigned long droppedPeriods[NUMBER_OF_AVAILABLE_TIMERS];				//Expiries that never got a call
+unsigned int pendingMissedPeriods[NUMBER_OF_AVAILABLE_TIMERS];			//Coalesced periods waiting for the next call
+unsigned int callMissedPeriods[NUMBER_OF_AVAILABLE_TIMERS];			//Coalesced periods covered by the call in progress
+enum TIMER1_CLOCK timer1Clock = INSTRUCTION_CLOCK;						//Which timebase Timer1 is running from
+unsigned long long timer1RequestedNS = 0;								//Timer1 period asked for through Change_Timer_Time, every timebase is solved from this
+unsigned long long timer1PeriodNS = 0;									//Actual length of a Timer1 period on the current timebase
+int soscRunning = 0;													//Set once Initialize_Timer1_SOSC has seen the crystal running
+unsigned long long timer1UptimeNS = 0;									//Whole periods (and handoff remainders) since Timer1 was initialized
+const int timer1Prescale[4] = {1, 8, 64, 256};							//Divide of each T1CONbits.TCKPS setting
 
 /*************Function  Prototypes***************/
 void __attribute__ ((interrupt, no_auto_psv)) _T1Interrupt(void);
 void __attribute__ ((interrupt, no_auto_psv)) _T2Interrupt(void);
 void __attribute__ ((interrupt, no_auto_psv)) _T3Interrupt(void);
 void __attribute__ ((interrupt, no_auto_psv)) _T4Interrupt(void);
+unsigned int Service_Timer_Interrupt(enum TIMERS_AVAILABLE timer, void (*interruptFunction)(void));
+void Clear_Timer_Flag(enum TIMERS_AVAILABLE timer);
+int Timer_Flag(enum TIMERS_AVAILABLE timer);
+int Set_Timer1_Period(unsigned long long targetTime);
+int Solve_Timer1_Period(unsigned long long targetTime, enum TIMER1_CLOCK clock, unsigned int *periodRegister, int *prescale);
+int Solve_Postscaled_Period(unsigned long long targetTime, unsigned int *periodRegister, int *prescale, int *postscale);
+void Apply_Timer1_Clock(void);
+unsigned long Timer1_Clock_Hz(enum TIMER1_CLOCK clock);
+unsigned long long Timer1_Ticks_To_NS(unsigned long ticks, enum TIMER1_CLOCK clock, int prescale);
 
 /************* Device Definitions ***************/
 /************* Module Definitions ***************/
@@ -79,20 +147,18 @@ int Initialize_Timer(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS uni
 //				PR1			=		//Taken Care of elsewhere
 
 				//Timer1 Control Register
-				T1CONbits.TCS	= 0;	//0 = Internal clock (FOSC/2)
-//				T1CONbits.TSYNC	=		//Not used because TCS = 0
+				Apply_Timer1_Clock();	//TCS, TSYNC and T1ECS depend on the timebase chosen with Change_Timer1_Clock
 //				T1CONbits.TCKPS	=		//Taken Care of else where
 				T1CONbits.TGATE	= 0;	//0 = Gated time accumulation is disabled
-//				T1CONbits.T1ECS	=		//Not valid because TCS = 0
 				T1CONbits.TSIDL	= 0;	//0 = Continue module operation in Idle mode
+				TMR1			= 0;	//Start counting from the beginning of a period
+				timer1UptimeNS	= 0;	//Start keeping time fresh
 				T1CONbits.TON	= 1;	//1 = Starts 16-bit Timer1
 
-				//Only setup the interrupts if we have a valid function pointer
+				//Only setup the function if we have a valid function pointer
 				if(interruptFunction)//Check for null pointer
-				{
 					TMR1_interruptFunction = interruptFunction;//Setup the function to call in the interrupt routine
-					IEC0bits.T1IE = 1;//Enable the interrupt
-				}
+				IEC0bits.T1IE = 1;//Enable the interrupt, Timer1 always needs it to keep the uptime
 			#elif defined PLACE_MICROCHIP_PART_NAME_HERE
 				return 0;//Timer1 does not exist on this chip, as such, this function call has failed
 			#else
@@ -288,6 +354,7 @@ int Change_Timer_Trigger(enum TIMERS_AVAILABLE timer, int newState)
 
 int Current_Timer(enum TIMERS_AVAILABLE timer, enum TIMER_UNITS units)
 {
+	unsigned long long timer1Time;
 	long time;
 
 	//Range check
@@ -298,43 +365,24 @@ int Current_Timer(enum TIMERS_AVAILABLE timer, enum TIMER_UNITS units)
 	switch(timer)
 	{
 		case 0:
-			//Apply prescalar
-			switch(T1CONbits.TCKPS)
-			{
-				case 0://1:1
-					time = TMR1 * 1 * MIN_PERIOD_NS;
-					break;
-				case 1://1:8
-					time = TMR1 * 8 * MIN_PERIOD_NS;
-					break;
-				case 2://1:64
-					time = TMR1 * 64 * MIN_PERIOD_NS;
-					break;
-				case 3://1:256
-					time = TMR1 * 256 * MIN_PERIOD_NS;
-					break;
-			}
+			//Apply prescalar and the tick period of whichever clock is in use, on the SOSC this can be far more nS than a long holds
+			timer1Time = Timer1_Ticks_To_NS(TMR1, timer1Clock, T1CONbits.TCKPS);
 
 			//Apply units modifier and return finished value
 			switch(units)
 			{
 				case SECONDS:
-					time /= 1000000000;
+					return (int)(timer1Time / 1000000000);
 				case MILLI_SECONDS:
-					time /= 1000000;
+					return (int)(timer1Time / 1000000);
 				case MICRO_SECONDS:
-					time /= 1000;
+					return (int)(timer1Time / 1000);
 				case NANO_SECONDS:
-					time /= 1;
 				case TICKS:
-					time;
-					break;
+					return (int)timer1Time;
 				default:
 					return 0;//Invalid units
 			}
-
-			//Return the adjusted time in the requested time units
-			return (int)time;
 		case 1:
 			//Apply prescalar and postscalar
 			switch(T2CONbits.T2CKPS)
@@ -459,25 +507,29 @@ int Current_Timer(enum TIMERS_AVAILABLE timer, enum TIMER_UNITS units)
 
 int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS units)
 {
-	long targetTime;
-	int periodRegister;
+	unsigned long long targetTime;
+	unsigned int periodRegister;
 	int prescale;
 	int postscale;
 
-	//Determine the target time in nS
+	//Range check
+	if(time <= 0)
+		return 0;//Out of range
+
+	//Determine the target time in nS, a long only holds 2.1 S of nS so this is done in 64 bits
 	switch(units)
 	{
 		case SECONDS:
-			targetTime = time * 1000000000;//Change to the appropriate resolution
+			targetTime = (unsigned long long)time * 1000000000;//Change to the appropriate resolution
 			break;
 		case MILLI_SECONDS:
-			targetTime = time * 1000000;//Change to the appropriate resolution
+			targetTime = (unsigned long long)time * 1000000;//Change to the appropriate resolution
 			break;
 		case MICRO_SECONDS:
-			targetTime = time * 1000;//Change to the appropriate resolution
+			targetTime = (unsigned long long)time * 1000;//Change to the appropriate resolution
 			break;
 		case NANO_SECONDS:
-			targetTime = time * 1;//Change to the appropriate resolution
+			targetTime = (unsigned long long)time * 1;//Change to the appropriate resolution
 			break;
 		case TICKS:
 			targetTime = time;//Change to the appropriate resolution
@@ -490,115 +542,29 @@ int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS un
 	switch(timer)
 	{
 		case 0://Timer 1
-			//Determine Prescaler and Period Register - Attempt to minimize the prescalar to retain resolution
-			prescale = targetTime;		//Assign time to beat
-			prescale /= 0xFF;			//Divide by a maxed out period register
-			prescale /= MIN_PERIOD_NS;	//Divide by the minimum period
-			if(prescale == 0)
-			{
-				prescale = 0;//1:1
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 1 * MIN_PERIOD_NS;//Divide by prescaler and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else if((prescale > 0) && (prescale <= 8))
-			{
-				prescale = 1;//1:8
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 8 * MIN_PERIOD_NS;//Divide by prescaler and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else if((prescale > 8) && (prescale <= 64))
-			{
-				prescale = 2;//1:64
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 64 * MIN_PERIOD_NS;//Divide by prescaler and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else if((prescale > 64) && (prescale <= 256))
-			{
-				prescale = 3;//1:256
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 256 * MIN_PERIOD_NS;//Divide by prescaler and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else
-				return 0;//Out of range with a maxed out prescalar AND period register
-
-			//Make it official
-			PR1 = periodRegister;		//The value to trigger an interrupt at
-			T1CONbits.TCKPS	= prescale;	//Timer1 Input Clock Prescale Select bits (0 = 1:1, 1 = 1:8, 2 = 1:64, 3 = 1:256)
-
+			if(Set_Timer1_Period(targetTime) == 0)//The tick period depends on which clock Timer1 is running from
+				return 0;//Out of range
+			timer1RequestedNS = targetTime;//Clock handoffs solve from this, the rounded period would drift a little further every handoff
 			return 1;//Success
 		case 1://Timer 2
-			//Determine postscaler and Period Register - Attempt to minimize the postscalar to retain resolution
-			postscale = targetTime;		//Assign time to beat
-			postscale /= 0xFF;			//Divide by a maxed out period register
-			postscale /= 16;			//Divide by a maxed out prescaler
-			postscale /= MIN_PERIOD_NS;	//Divide by the minimum period
-			postscale++;				//Add one to get the correct post scalar
-
-			//Range check
-			if(postscale > 16)
+			//Determine Prescaler, Postscaler and Period Register
+			if(Solve_Postscaled_Period(targetTime, &periodRegister, &prescale, &postscale) == 0)
 				return 0;//Out of range with a maxed out postscalar AND prescalar AND period register
 
-			//Determine Prescaler and Period Register - Attempt to minimize the prescalar to retain resolution
-			prescale = targetTime;		//Assign time to beat
-			prescale /= 0xFF;			//Divide by a maxed out period register
-			prescale /= MIN_PERIOD_NS;	//Divide by the minimum period
-			prescale /= postscale;		//Divide by already determined postscale value
-			if(prescale == 0)
-			{
-				prescale = 0;//1:1
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 1 * MIN_PERIOD_NS * postscale;//Divide by prescaler, postscaler, and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else if((prescale > 0) && (prescale <= 4))
-			{
-				prescale = 1;//1:4
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 4 * MIN_PERIOD_NS * postscale;//Divide by prescaler, postscaler, and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else if((prescale > 4) && (prescale <= 16))
-			{
-				prescale = 2;//1:16
-				periodRegister = targetTime * 10;//Gain resolution
-				periodRegister /= 16 * MIN_PERIOD_NS * postscale;//Divide by prescaler, postscaler, and the miniumum period
-				periodRegister += 5;//Allow for rounding
-				periodRegister /= 10;//Lose the gained resolution
-			}
-			else
-				return 0;//Something went wrong, we should be in range...?
-
 			//Make it official
 			PR2					= periodRegister;	//The value to trigger an interrupt at
-			T2CONbits.T2OUTPS	= postscale;		//Timer2 Output Postscale Select bits (0 = 1:1, 1 = 1:2, 2 = 1:3,... 15 = 1:16)
-			T2CONbits.T2OUTPS	= postscale;		//Timer2 Output Postscale Select bits (0 = 1:1, 1 = 1:2, 2 = 1:3,... 15 = 1:16)
+			T2CONbits.T2OUTPS	= postscale - 1;	//Timer2 Output Postscale Select bits (0 = 1:1, 1 = 1:2, 2 = 1:3,... 15 = 1:16)
+			T2CONbits.T2CKPS	= prescale;			//Timer2 Clock Prescale Select bits (0 = 1:1, 1 = 1:4, 2 = 1:16, 3 = Undefined)
 
 			return 1;//Success
 		case 2://Timer 3
-			//Determine Prescaler - Attempt to minimize the prescalar to retain resolution
-			Change_Timer_Time(TIMER3, time, units);
-			prescale = targetTime;		//Assign time to beat
-			prescale /= MIN_PERIOD_NS;	//Divide by the minimum period
-			if(prescale == 0)
-				prescale = 0;//1:1
-			else if((prescale > 0) && (prescale <= 2))
-				prescale = 1;//1:2
-			else if((prescale > 2) && (prescale <= 4))
-				prescale = 2;//1:4
-			else if((prescale > 4) && (prescale <= 8))
-				prescale = 3;//1:8
-			else
-				return 0;//Out of range with a maxed out prescalar AND period register
+			//Determine Prescaler - Timer3 has no period register, it always rolls over after 0x10000 counts
+			//so the only periods it can make are a full rollover at each prescaler, anything else is refused
+			for(prescale = 0; prescale < 4; prescale++)
+				if(targetTime == (0x10000UL << prescale) * MIN_PERIOD_NS)
+					break;//Exactly one rollover at 1:1, 1:2, 1:4 or 1:8
+			if(prescale == 4)
+				return 0;//Not one of the periods Timer3 can make
 
 			//Make it official
 			T3CONbits.T3CKPS = prescale;	//Timer3 Input Clock Prescale Select bits (0 = 1:1, 1 = 1:2, 2 = 1:4, 3 = 1:8)
@@ -608,52 +574,13 @@ int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS un
 			#if defined __PIC24F08KL200__
 				return 0;//Timer4 does not exist on this chip, as such, this function call has failed
 			#elif defined PLACE_MICROCHIP_PART_NAME_HERE
-				//Determine postscaler and Period Register - Attempt to minimize the postscalar to retain resolution
-				postscale = targetTime;		//Assign time to beat
-				postscale /= 0xFF;			//Divide by a maxed out period register
-				postscale /= 16;			//Divide by a maxed out prescaler
-				postscale /= MIN_PERIOD_NS;	//Divide by the minimum period
-				postscale++;				//Add one to get the correct post scalar
-
-				//Range check
-				if(postscale > 16)
+				//Determine Prescaler, Postscaler and Period Register
+				if(Solve_Postscaled_Period(targetTime, &periodRegister, &prescale, &postscale) == 0)
 					return 0;//Out of range with a maxed out postscalar AND prescalar AND period register
 
-				//Determine Prescaler and Period Register - Attempt to minimize the prescalar to retain resolution
-				prescale = targetTime;		//Assign time to beat
-				prescale /= 0xFF;			//Divide by a maxed out period register
-				prescale /= MIN_PERIOD_NS;	//Divide by the minimum period
-				prescale /= postscale;		//Divide by already determined postscale value
-				if(prescale == 0)
-				{
-					prescale = 0;//1:1
-					periodRegister = targetTime * 10;//Gain resolution
-					periodRegister /= 1 * MIN_PERIOD_NS * postscale;//Divide by prescaler, postscaler, and the miniumum period
-					periodRegister += 5;//Allow for rounding
-					periodRegister /= 10;//Lose the gained resolution
-				}
-				else if((prescale > 0) && (prescale <= 4))
-				{
-					prescale = 1;//1:4
-					periodRegister = targetTime * 10;//Gain resolution
-					periodRegister /= 4 * MIN_PERIOD_NS * postscale;//Divide by prescaler, postscaler, and the miniumum period
-					periodRegister += 5;//Allow for rounding
-					periodRegister /= 10;//Lose the gained resolution
-				}
-				else if((prescale > 4) && (prescale <= 16))
-				{
-					prescale = 2;//1:16
-					periodRegister = targetTime * 10;//Gain resolution
-					periodRegister /= 16 * MIN_PERIOD_NS * postscale;//Divide by prescaler, postscaler, and the miniumum period
-					periodRegister += 5;//Allow for rounding
-					periodRegister /= 10;//Lose the gained resolution
-				}
-				else
-					return 0;//Something went wrong, we should be in range...?
-
 				//Make it official
 				PR4					= periodRegister;	//The value to trigger an interrupt at
-				T4CONbits.T4OUTPS	= postscale;		//Timer4 Output Postscale Select bits (0 = 1:1, 1 = 1:2, 2 = 1:3,... 15 = 1:16)
+				T4CONbits.T4OUTPS	= postscale - 1;	//Timer4 Output Postscale Select bits (0 = 1:1, 1 = 1:2, 2 = 1:3,... 15 = 1:16)
 				T4CONbits.T4CKPS	= prescale;			//Timer4 Clock Prescale Select bits (0 = 1:1, 1 = 1:4, 2 = 1:16, 3 = Undefined)
 
 				return 1;//Success
@@ -668,9 +595,491 @@ int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS un
 	return 0;
 }
 
+int Change_Timer_Overrun_Policy(enum TIMERS_AVAILABLE timer, enum TIMER_OVERRUN_POLICY policy)
+{
+	int oldIPL;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if((policy != SKIP_MISSED_PERIODS) && (policy != COALESCE_MISSED_PERIODS) && (policy != CATCH_UP_MISSED_PERIODS))
+		return 0;//Out of range
+
+	//Make it official and start counting fresh, interrupts are held off so the two word counts are not cleared half way through an update
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+	overrunPolicy[timer]		= policy;
+	overrunCount[timer]			= 0;
+	droppedPeriods[timer]		= 0;
+	pendingMissedPeriods[timer]	= 0;
+	callMissedPeriods[timer]	= 0;
+	SRbits.IPL = oldIPL;
+
+	//Success
+	return 1;
+}
+
+unsigned long Timer_Overruns(enum TIMERS_AVAILABLE timer)
+{
+	unsigned long count;
+	int oldIPL;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	//Hold off interrupts, the count is two words and the interrupt could change it between reading them
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+	count = overrunCount[timer];
+	SRbits.IPL = oldIPL;
+
+	return count;
+}
+
+unsigned long Timer_Dropped_Periods(enum TIMERS_AVAILABLE timer)
+{
+	unsigned long count;
+	int oldIPL;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	//Hold off interrupts, the count is two words and the interrupt could change it between reading them
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+	count = droppedPeriods[timer];
+	SRbits.IPL = oldIPL;
+
+	return count;
+}
+
+unsigned int Timer_Missed_Periods(enum TIMERS_AVAILABLE timer)
+{
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	return callMissedPeriods[timer];
+}
+
+int Initialize_Timer1_SOSC(void)
+{
+	int startup;
+
+	if(soscRunning)
+		return 1;//Already running
+
+	#if defined __PIC24F08KL200__
+		if(T1CONbits.TON || timer1RequestedNS)
+			return 0;//Timer1 is needed to watch the crystal start, this has to be done before Timer1 is initialized
+
+		__builtin_write_OSCCONL(OSCCON | 0x02);//OSCCONbits.SOSCEN = 1, this register is write protected
+
+		//There is no ready flag for the SOSC, so count it on Timer1 until it has run as long as the oscillator start-up timer would wait
+		T1CONbits.TGATE	= 0;	//0 = Gated time accumulation is disabled
+		T1CONbits.TCKPS	= 0;	//1:1, count every crystal cycle
+		T1CONbits.T1ECS	= 0;	//0 = Secondary Oscillator (SOSC) is the extended clock source
+		T1CONbits.TSYNC	= 0;	//0 = Do not synchronize
+		T1CONbits.TCS	= 1;	//1 = Extended clock source selected by T1ECS
+		PR1				= 0xFFFF;
+		TMR1			= 0;
+		T1CONbits.TON	= 1;
+		for(startup = 0; TMR1 < SOSC_STARTUP_TICKS; startup++)
+		{
+			if(startup >= SOSC_STARTUP_MS)
+			{
+				//The crystal never started, leave everything off
+				T1CONbits.TON = 0;
+				__builtin_write_OSCCONL(OSCCON & ~0x02);//OSCCONbits.SOSCEN = 0
+				Apply_Timer1_Clock();
+				return 0;
+			}
+			__delay32(FOSC_HZ/2/1000);//1 mS
+		}
+
+		//Hand Timer1 back untouched
+		T1CONbits.TON	= 0;
+		TMR1			= 0;
+		IFS0bits.T1IF	= 0;
+		Apply_Timer1_Clock();
+		soscRunning = 1;
+	#elif defined PLACE_MICROCHIP_PART_NAME_HERE
+		return 0;//Timer1 does not exist on this chip, as such, this function call has failed
+	#else
+		#warning "Timer1 is not setup for this chip"
+	#endif
+
+	//Success
+	return 1;
+}
+
+int Change_Timer1_Clock(enum TIMER1_CLOCK clock)
+{
+	enum TIMER1_CLOCK oldClock = timer1Clock;
+	unsigned long long numerator;
+	unsigned long long denominator;
+	unsigned long long bankedNS;
+	unsigned long tickRatio;
+	unsigned long long newPeriodNS;
+	unsigned long long oldPeriodNS = timer1PeriodNS;
+	unsigned int newPeriod;
+	unsigned int oldTicks;
+	unsigned int newTicks;
+	int newPrescale;
+	int oldPrescale;
+	int ratioShift;
+	int pendingExpiry;
+	int oldIPL;
+
+	//Range check
+	if((clock != INSTRUCTION_CLOCK) && (clock != SECONDARY_OSCILLATOR))
+		return 0;//Out of range
+	if(clock == timer1Clock)
+		return 1;//Already there
+	if((clock == SECONDARY_OSCILLATOR) && !soscRunning)
+		return 0;//Initialize_Timer1_SOSC has not seen the crystal running
+
+	#if defined __PIC24F08KL200__
+		//Solve everything for the new timebase while Timer1 is still running, from the period that was asked for
+		if(Solve_Timer1_Period(timer1RequestedNS, clock, &newPeriod, &newPrescale) == 0)
+			return 0;//The period can not be made on the new timebase, Timer1 is left untouched
+		oldPrescale = T1CONbits.TCKPS;
+		newPeriodNS = Timer1_Ticks_To_NS((unsigned long)newPeriod + 1, clock, newPrescale);//The timer counts 0 to PR1, so a period is PR1 + 1 ticks
+
+		//New ticks per old tick, kept as a 16 bit fraction so the conversion while stopped is one 32 bit multiply and a shift
+		numerator = (unsigned long long)Timer1_Clock_Hz(clock) * timer1Prescale[oldPrescale];
+		denominator = (unsigned long long)Timer1_Clock_Hz(oldClock) * timer1Prescale[newPrescale];
+		for(ratioShift = 0; (ratioShift < 16) && (((numerator << (ratioShift + 1)) / denominator) <= 0xFFFF); ratioShift++)
+			;
+		tickRatio = (numerator << ratioShift) / denominator;
+
+		//Freeze Timer1 for as short a time as possible, nothing in here may loop or divide
+		oldIPL = SRbits.IPL;
+		SRbits.IPL = HIGHEST_IPL;
+		T1CONbits.TON = 0;
+		oldTicks = TMR1;
+		pendingExpiry = IFS0bits.T1IF;//Matched but not yet serviced
+		newTicks = ((unsigned long)oldTicks * tickRatio) >> ratioShift;
+		if(newTicks > newPeriod)
+			newTicks = newPeriod;//The rounded period came out shorter, do not let the timer run past its match
+		timer1Clock = clock;
+		Apply_Timer1_Clock();
+		PR1 = newPeriod;
+		T1CONbits.TCKPS = newPrescale;
+		TMR1 = newTicks;
+		T1CONbits.TON = 1;
+		timer1PeriodNS = newPeriodNS;
+		SRbits.IPL = oldIPL;
+
+		//Bank what the new timebase could not carry, the time Timer1 was stopped for and, if a match was pending, the difference in period the interrupt will count
+		bankedNS = Timer1_Ticks_To_NS(oldTicks, oldClock, oldPrescale) - Timer1_Ticks_To_NS(newTicks, clock, newPrescale);
+		bankedNS += (TIMER1_HANDOFF_CYCLES * 1000000000ULL) / (FOSC_HZ/2);
+		if(pendingExpiry)
+			bankedNS += oldPeriodNS - newPeriodNS;//Wraps when the new period is longer, which still adds up correctly
+		oldIPL = SRbits.IPL;
+		SRbits.IPL = HIGHEST_IPL;
+		timer1UptimeNS += bankedNS;
+		SRbits.IPL = oldIPL;
+	#elif defined PLACE_MICROCHIP_PART_NAME_HERE
+		return 0;//Timer1 does not exist on this chip, as such, this function call has failed
+	#else
+		#warning "Timer1 is not setup for this chip"
+	#endif
+
+	//Success
+	return 1;
+}
+
+int Sleep_Until_Timer1(void)
+{
+	//Hand Timer1 over to the SOSC, the instruction clock stops in Sleep
+	if(Change_Timer1_Clock(SECONDARY_OSCILLATOR) == 0)
+		return 0;//Could not hand off, sleeping now would lose time
+
+	//Only a Timer1 interrupt is needed to wake us back up
+	IEC0bits.T1IE = 1;
+	Sleep();
+
+	//Back on the fast timebase for the best resolution while awake
+	Change_Timer1_Clock(INSTRUCTION_CLOCK);
+
+	//Success
+	return 1;
+}
+
+unsigned long long Timer1_Uptime(enum TIMER_UNITS units)
+{
+	unsigned long long uptime;
+	unsigned int ticks;
+	int oldIPL;
+
+	//Hold off interrupts so the period count and the timer agree
+	oldIPL = SRbits.IPL;
+	SRbits.IPL = HIGHEST_IPL;
+	ticks = TMR1;
+	uptime = timer1UptimeNS;
+	if(IFS0bits.T1IF)//The timer matched but the interrupt has not been serviced yet
+	{
+		ticks = TMR1;
+		uptime += timer1PeriodNS;
+	}
+	SRbits.IPL = oldIPL;
+	uptime += Timer1_Ticks_To_NS(ticks, timer1Clock, T1CONbits.TCKPS);
+
+	//Apply units modifier and return finished value
+	switch(units)
+	{
+		case SECONDS:
+			return uptime / 1000000000;
+		case MILLI_SECONDS:
+			return uptime / 1000000;
+		case MICRO_SECONDS:
+			return uptime / 1000;
+		case NANO_SECONDS:
+		case TICKS:
+			return uptime;
+		default:
+			return 0;//Invalid units
+	}
+}
+
+int Set_Timer1_Period(unsigned long long targetTime)
+{
+	unsigned int periodRegister;
+	int prescale;
+
+	if(Solve_Timer1_Period(targetTime, timer1Clock, &periodRegister, &prescale) == 0)
+		return 0;//Out of range
+
+	//Make it official
+	PR1				= periodRegister;	//The value to trigger an interrupt at
+	T1CONbits.TCKPS	= prescale;			//Timer1 Input Clock Prescale Select bits (0 = 1:1, 1 = 1:8, 2 = 1:64, 3 = 1:256)
+	timer1PeriodNS	= Timer1_Ticks_To_NS((unsigned long)periodRegister + 1, timer1Clock, prescale);//What a period really is once rounded to the tick, the timer counts 0 to PR1
+
+	return 1;//Success
+}
+
+int Solve_Timer1_Period(unsigned long long targetTime, enum TIMER1_CLOCK clock, unsigned int *periodRegister, int *prescale)
+{
+	unsigned long long clockTicks;
+	unsigned long long periodTicks;
+	int divider;
+
+	//Determine Prescaler and Period Register - Attempt to minimize the prescalar to retain resolution
+	//Work from the clock frequency rather than the tick period, the SOSC tick is not a whole number of nS
+	if(targetTime > (0xFFFFFFFFFFFFFFFFULL / Timer1_Clock_Hz(clock)))
+		return 0;//Out of range, far longer than a maxed out prescalar AND period register
+	clockTicks = targetTime * Timer1_Clock_Hz(clock);	//Ticks needed, scaled up by 10^9
+	for(divider = 0; divider < 4; divider++)
+	{
+		periodTicks = clockTicks + (500000000ULL * timer1Prescale[divider]);//Allow for rounding
+		periodTicks /= 1000000000ULL * timer1Prescale[divider];//Lose the gained resolution and divide by the prescaler
+		if(periodTicks <= 0x10000)
+			break;//Fits in the period register, which holds one less than the ticks in a period
+	}
+	if(divider == 4)
+		return 0;//Out of range with a maxed out prescalar AND period register
+	if(periodTicks == 0)
+		return 0;//Shorter than a single tick
+
+	*periodRegister = periodTicks - 1;//The timer counts 0 to PR1, so a period is PR1 + 1 ticks
+	*prescale = divider;
+
+	return 1;//Success
+}
+
+int Solve_Postscaled_Period(unsigned long long targetTime, unsigned int *periodRegister, int *prescale, int *postscale)
+{
+	unsigned long long ticks;
+	unsigned long divider;
+
+	//Range check
+	if(targetTime > 0xFFFFFFFFULL)
+		return 0;//Far past what a maxed out prescaler, postscaler and period register can reach, this also keeps the multiply below from overflowing
+
+	//Solve from the instruction clock itself, MIN_PERIOD_NS is truncated (62 instead of 62.5 at 32 MHz)
+	ticks = (targetTime * (FOSC_HZ / 2) + 500000000ULL) / 1000000000ULL;	//Nearest number of instruction clock ticks
+	if(ticks == 0)
+		return 0;//Shorter than a single tick
+
+	//Smallest combined prescale and postscale that lets the 8 bit period register reach, the smaller it is the finer the resolution
+	divider = (ticks + 0x100 - 1) / 0x100;	//A period is PR2 + 1 counts, so a maxed out period register counts 0x100
+	if(divider <= 16)
+	{
+		*prescale = 0;//1:1
+		*postscale = divider;
+	}
+	else if(divider <= 4 * 16)
+	{
+		*prescale = 1;//1:4
+		*postscale = (divider + 3) / 4;
+	}
+	else if(divider <= 16 * 16)
+	{
+		*prescale = 2;//1:16
+		*postscale = (divider + 15) / 16;
+	}
+	else
+		return 0;//Out of range with a maxed out postscalar AND prescalar AND period register
+
+	//Round to the nearest count of the chosen divide
+	divider = (1UL << (2 * *prescale)) * *postscale;	//Ticks per count of the period register
+	ticks = (targetTime * (FOSC_HZ / 2) + 500000000ULL * divider) / (1000000000ULL * divider);
+	if(ticks > 0x100)
+		ticks = 0x100;//Rounded up past the top
+	else if(ticks == 0)
+		ticks = 1;//Rounded down to nothing
+	*periodRegister = ticks - 1;//The timer counts PR2 + 1 ticks per period
+
+	return 1;//Success
+}
+
+void Apply_Timer1_Clock(void)
+{
+	#if defined __PIC24F08KL200__
+		if(timer1Clock == SECONDARY_OSCILLATOR)
+		{
+			T1CONbits.T1ECS	= 0;	//0 = Secondary Oscillator (SOSC) is the extended clock source
+			T1CONbits.TSYNC	= 0;	//0 = Do not synchronize, Timer1 has to run asynchronously to keep counting in Sleep
+			T1CONbits.TCS	= 1;	//1 = Extended clock source selected by T1ECS
+		}
+		else
+		{
+			T1CONbits.TCS	= 0;	//0 = Internal clock (FOSC/2)
+//			T1CONbits.TSYNC	=		//Not used because TCS = 0
+//			T1CONbits.T1ECS	=		//Not valid because TCS = 0
+		}
+	#endif
+
+	return;
+}
+
+unsigned long Timer1_Clock_Hz(enum TIMER1_CLOCK clock)
+{
+	if(clock == SECONDARY_OSCILLATOR)
+		return SOSC_HZ;
+	return FOSC_HZ/2;//Instruction clock
+}
+
+unsigned long long Timer1_Ticks_To_NS(unsigned long ticks, enum TIMER1_CLOCK clock, int prescale)
+{
+	unsigned long long time;
+
+	//Apply prescalar and the clock's tick period
+	time = (unsigned long long)ticks * timer1Prescale[prescale];
+	time *= 1000000000ULL;
+	time /= Timer1_Clock_Hz(clock);
+
+	return time;
+}
+
+unsigned int Service_Timer_Interrupt(enum TIMERS_AVAILABLE timer, void (*interruptFunction)(void))
+{
+	unsigned int matches = 1;//The match that brought us here
+	int calls = 0;
+
+	while(1)
+	{
+		//Clear the flag before running so an expiry during the call can be seen
+		Clear_Timer_Flag(timer);
+
+		//Hand any coalesced periods to this call
+		callMissedPeriods[timer] = pendingMissedPeriods[timer];
+		pendingMissedPeriods[timer] = 0;
+
+		interruptFunction();//Run the associated function
+		calls++;
+
+		//Finished before the next period, all is well
+		if(Timer_Flag(timer) == 0)
+			return matches;
+
+		//The timer expired again while the function was still running
+		matches++;
+		if(overrunCount[timer] != 0xFFFFFFFF)
+			overrunCount[timer]++;
+
+		switch(overrunPolicy[timer])
+		{
+			case COALESCE_MISSED_PERIODS:
+				Clear_Timer_Flag(timer);
+				if(pendingMissedPeriods[timer] != 0xFFFF)
+					pendingMissedPeriods[timer]++;//The next call covers this period as well
+				return matches;
+			case CATCH_UP_MISSED_PERIODS:
+				if(calls < TIMER_CATCH_UP_LIMIT)
+					break;//Run it again straight away
+				//Too far behind, keep the loop bounded and drop the rest
+			case SKIP_MISSED_PERIODS:
+			default:
+				Clear_Timer_Flag(timer);
+				if(droppedPeriods[timer] != 0xFFFFFFFF)
+					droppedPeriods[timer]++;
+				return matches;
+		}
+	}
+}
+
+void Clear_Timer_Flag(enum TIMERS_AVAILABLE timer)
+{
+	switch(timer)
+	{
+		case 0:
+			IFS0bits.T1IF = 0;
+			break;
+		case 1:
+			IFS0bits.T2IF = 0;
+			break;
+		case 2:
+			IFS0bits.T3IF = 0;
+			break;
+		case 3:
+			#if defined PLACE_MICROCHIP_PART_NAME_HERE
+				IFS1bits.T4IF = 0;
+			#endif
+			break;
+		default:
+			break;//How did we get here?
+	}
+
+	return;
+}
+
+int Timer_Flag(enum TIMERS_AVAILABLE timer)
+{
+	switch(timer)
+	{
+		case 0:
+			return IFS0bits.T1IF;
+		case 1:
+			return IFS0bits.T2IF;
+		case 2:
+			return IFS0bits.T3IF;
+		case 3:
+			#if defined PLACE_MICROCHIP_PART_NAME_HERE
+				return IFS1bits.T4IF;
+			#endif
+		default:
+			return 0;//How did we get here?
+	}
+}
+
 void __attribute__ ((interrupt, no_auto_psv)) _T1Interrupt(void)
 {
-	TMR1_interruptFunction();//Run the associated function
+	unsigned int matches;
+
+	timer1UptimeNS += timer1PeriodNS;//Keep time, even if there is nothing to run
+
+	if(TMR1_interruptFunction)//Check for null pointer, Timer1 may only be waking us from Sleep
+	{
+		matches = Service_Timer_Interrupt(TIMER1, TMR1_interruptFunction);//Run the associated function and handle any overruns
+		while(--matches)
+			timer1UptimeNS += timer1PeriodNS;//Periods that matched while the function was running
+	}
+	else
+		IFS0bits.T1IF = 0;
 
 	//Return to where we left off
 	return;
@@ -678,7 +1087,7 @@ void __attribute__ ((interrupt, no_auto_psv)) _T1Interrupt(void)
 
 void __attribute__ ((interrupt, no_auto_psv)) _T2Interrupt(void)
 {
-	TMR2_interruptFunction();//Run the associated function
+	Service_Timer_Interrupt(TIMER2, TMR2_interruptFunction);//Run the associated function and handle any overruns
 
 	//Return to where we left off
 	return;
@@ -686,7 +1095,7 @@ void __attribute__ ((interrupt, no_auto_psv)) _T2Interrupt(void)
 
 void __attribute__ ((interrupt, no_auto_psv)) _T3Interrupt(void)
 {
-	TMR3_interruptFunction();//Run the associated function
+	Service_Timer_Interrupt(TIMER3, TMR3_interruptFunction);//Run the associated function and handle any overruns
 
 	//Return to where we left off
 	return;
@@ -694,7 +1103,9 @@ void __attribute__ ((interrupt, no_auto_psv)) _T3Interrupt(void)
 
 void __attribute__ ((interrupt, no_auto_psv)) _T4Interrupt(void)
 {
-	TMR4_interruptFunction();//Run the associated function
+	#if defined PLACE_MICROCHIP_PART_NAME_HERE
+		Service_Timer_Interrupt(TIMER4, TMR4_interruptFunction);//Run the associated function and handle any overruns
+	#endif
 
 	//Return to where we left off
 	return;
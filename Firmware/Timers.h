@@ -3,11 +3,22 @@
 
 /************* Semantic Versioning***************/
 #define TIMERS_LIBRARY
+#define TIMERS_MAJOR	0
+#define TIMERS_MINOR	6
+#define TIMERS_PATCH	8
 
 /*************   Magic  Numbers   ***************/
 #define NO_TIMER_INTERRUPT	(void*)0
 #define TIMER_ON	1
 #define TIMER_OFF	0
+#define TIMER_CATCH_UP_LIMIT	4	//Most back to back calls CATCH_UP_MISSED_PERIODS will make in one interrupt before it starts dropping periods
+#define MIN_PERIOD_NS (1000000000/(FOSC_HZ/2))	//Period of the instruction clock pulse in nanoseconds, FOSC_HZ comes from Config.h
+#define HIGHEST_IPL	7	//CPU priority that holds off every user interrupt
+#if defined __linux__
+	#ifndef HOST_TIMERS
+		#define HOST_TIMERS	4096	//Number of simulated timers available to the POSIX backend (Timers_POSIX.c)
+	#endif
+#endif
 
 /*************    Enumeration     ***************/
 enum TIMERS_AVAILABLE
@@ -21,6 +32,12 @@ enum TIMERS_AVAILABLE
 	TIMER2,
 	TIMER3,
 	TIMER4,
+#elif defined __linux__
+	TIMER1,
+	TIMER2,
+	TIMER3,
+	TIMER4,
+	LAST_HOST_TIMER = HOST_TIMERS - 1,
 #else
 	#warning "This chip is not setup for timers yet"
 #endif
@@ -36,7 +53,22 @@ enum TIMER_UNITS
 	TICKS
 };
 
+enum TIMER_OVERRUN_POLICY
+{
+	SKIP_MISSED_PERIODS,		//A period that expires while the function is still running is dropped
+	COALESCE_MISSED_PERIODS,	//A period that expires while the function is still running is folded into the next call, see Timer_Missed_Periods
+	CATCH_UP_MISSED_PERIODS		//The function is called again straight away for every missed period, up to TIMER_CATCH_UP_LIMIT calls
+};
+
+enum TIMER1_CLOCK
+{
+	INSTRUCTION_CLOCK,		//FOSC/2, the finest resolution but it stops in Sleep
+	SECONDARY_OSCILLATOR	//SOSC (32.768 kHz crystal), keeps running in Sleep
+};
+
 /***********State Machine Definitions************/
+extern const int timer1Prescale[4];	//Divide of each Timer1 prescaler setting (1:1, 1:8, 1:64, 1:256)
+
 /*************Function  Prototypes***************/
 /**
  * Initializes the specified timer to have a set period
@@ -101,4 +133,113 @@ int Current_Timer(enum TIMERS_AVAILABLE timer, enum TIMER_UNITS units);
  */
 int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS units);
 
+/**
+ * Chooses what happens when a timer expires while its function is still running, call this after the timer has been initialized
+ * @param timer The target timer, use the enum TIMERS_AVAILABLE
+ * @param policy What to do with the missed periods, use the enum TIMER_OVERRUN_POLICY. SKIP_MISSED_PERIODS is used until this is called
+ * @return 1 = The policy was changed and the overrun counters were cleared\
+ * 0 = Either the timer was out of range or the policy was invalid
+ */
+int Change_Timer_Overrun_Policy(enum TIMERS_AVAILABLE timer, enum TIMER_OVERRUN_POLICY policy);
+
+/**
+ * Reports how many times the timer expired while its function was still running
+ * Only one expiry can be seen per call, a function that runs longer than two periods is still counted once
+ * @param timer The target timer, use the enum TIMERS_AVAILABLE
+ * @return The number of overruns since the policy was last set, saturates at 0xFFFFFFFF
+ */
+unsigned long Timer_Overruns(enum TIMERS_AVAILABLE timer);
+
+/**
+ * Reports how many periods never had the function called for them
+ * These are every overrun under SKIP_MISSED_PERIODS, or the overruns past TIMER_CATCH_UP_LIMIT under CATCH_UP_MISSED_PERIODS
+ * @param timer The target timer, use the enum TIMERS_AVAILABLE
+ * @return The number of dropped periods since the policy was last set, saturates at 0xFFFFFFFF
+ */
+unsigned long Timer_Dropped_Periods(enum TIMERS_AVAILABLE timer);
+
+/**
+ * Meant to be called from inside the timer's function when using COALESCE_MISSED_PERIODS
+ * @param timer The target timer, use the enum TIMERS_AVAILABLE
+ * @return The number of missed periods that the current call is covering on top of its own
+ */
+unsigned int Timer_Missed_Periods(enum TIMERS_AVAILABLE timer);
+
+/**
+ * Starts the secondary oscillator and waits until the crystal has counted for the oscillator start-up time, call this once at start up
+ * Timer1 is used to watch the crystal, so this has to be done before Timer1 is initialized
+ * @return 1 = The SOSC is running and Timer1 can be handed to it\
+ * 0 = Either Timer1 is already initialized or the crystal did not start (the SOSC is left off)
+ */
+int Initialize_Timer1_SOSC(void);
+
+/**
+ * Hands Timer1 over to a different clock without losing any accumulated time
+ * The period that was asked for is solved for the new tick length before Timer1 is stopped, then Timer1 is frozen for a short fixed time
+ * and picks up at the same point in its period. What the new tick can not carry and the time it was frozen for are added to the uptime
+ * @param clock The clock to run Timer1 from, use the enum TIMER1_CLOCK. Timer1 starts out on INSTRUCTION_CLOCK
+ * @return 1 = Timer1 is now running from the requested clock\
+ * 0 = Either the clock was out of range, the SOSC has not been started with Initialize_Timer1_SOSC\
+ * or the current period can not be made on the new clock (Timer1 is left untouched)
+ */
+int Change_Timer1_Clock(enum TIMER1_CLOCK clock);
+
+/**
+ * Puts the core to Sleep with Timer1 keeping time off of the SOSC, then hands Timer1 back to the instruction clock once awake
+ * Timer1 must already be initialized with the period to wake up at, and the SOSC started with Initialize_Timer1_SOSC
+ * @return 1 = The core slept and has woken back up\
+ * 0 = Timer1 could not be handed to the SOSC, the core did not Sleep
+ */
+int Sleep_Until_Timer1(void);
+
+/**
+ * Reports the time Timer1 has accumulated since it was initialized, across every clock handoff and Sleep
+ * @param units The units to use (S, mS, uS, nS). Use the enum TIMER_UNITS to correctly specify, TICKS reports nS
+ * @return The time since Timer1 was initialized in the units specified
+ */
+unsigned long long Timer1_Uptime(enum TIMER_UNITS units);
+
+#if defined __linux__
+/**
+ * Only available with the host backends (Timers_POSIX.c and Timers_Virtual.c), where many simulated devices can share one callback
+ * @return The timer whose function is being run by the calling thread\
+ * -1 = The calling thread is not running a timer function
+ */
+int Timer_In_Service(void);
+
+/**
+ * Only available with the host backends (Timers_POSIX.c and Timers_Virtual.c)
+ * With the POSIX backend, functions in the same shard are run one at a time, so a call can be late because of a slow function sharing its shard
+ * @return The time in nS of the expiry the calling thread is serving, on CLOCK_MONOTONIC (POSIX) or the virtual clock (Virtual)\
+ * -1 = The calling thread is not running a timer function
+ */
+long long Timer_Expiry_In_Service(void);
+#endif
+
+#if defined TIMERS_VIRTUAL_TIME
+/**
+ * Only available with the virtual time backend (Timers_Virtual.c)
+ * Moves the virtual clock forward, jumping straight from one period match to the next and calling each timer's function in tick order
+ * @param time How far to move the clock
+ * @param units The units to use (S, mS, uS, nS). Use the enum TIMER_UNITS to correctly specify
+ * @return 1 = The clock was moved and every match up to the new time has fired\
+ * 0 = Either an argument was out of range or this was called from inside a timer function
+ */
+int Advance_Virtual_Time(int time, enum TIMER_UNITS units);
+
+/**
+ * Only available with the virtual time backend (Timers_Virtual.c)
+ * Moves the virtual clock to the next period match and fires every timer that matches at that instant
+ * @return 1 = The clock was moved\
+ * 0 = Either no timer is waiting to expire or this was called from inside a timer function
+ */
+int Step_Virtual_Time(void);
+
+/**
+ * Only available with the virtual time backend (Timers_Virtual.c)
+ * @return The virtual clock in nS since the simulation started
+ */
+long long Virtual_Time(void);
+#endif
+
 #endif	/* TIMERS_H */
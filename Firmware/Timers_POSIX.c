@@ -0,0 +1,598 @@
+/**************************************************************************************************
+Authours:				Craig Comberbach
+Target Hardware:		Linux host (software in the loop)
+Chip resources used:	One timerfd and one worker thread per online core
+Code assumptions:		Compiled in place of Timers.c, link with -pthread
+						Timer functions run on worker threads, so anything they share with other timers must be thread safe
+						Each shard runs its timer functions one at a time, the same way timers sharing one interrupt priority do on the chip.
+						A slow function holds up every other timer in its shard and shows up in their overrun and dropped counts as well
+Purpose:				Provide the Timers.h API on a Linux host so application logic can run against simulated timers. Timers are sharded
+						across one worker per core, each worker keeps its timers in a min-heap and sleeps on a timerfd armed for the earliest expiry
+
+Version History:
+v0.2.0	2026-10-19  Craig Comberbach
+	Added Timer Expiry In Service so a function can measure how late it is against the expiry it was scheduled for
+	*BUG FIX* A worker thread that fails to start is no longer ignored, its timers would never have expired
+v0.1.0	2026-10-19  Craig Comberbach
+	Initialize Timer, Change Timer Time, Current Timer and Change Timer Trigger are implemented on top of CLOCK_MONOTONIC
+	Timers are split into per core shards, each with its own heap, timerfd and worker thread
+	Overrun policies match the hardware driver, but missed periods are counted exactly since the host knows the real time
+	Added Timer In Service so many simulated devices can share one function
+**************************************************************************************************/
+/*************    Header Files    ***************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "Timers.h"
+
+/************* Semantic Versioning***************/
+/************Arbitrary Functionality*************/
+/*************   Magic  Numbers   ***************/
+#define MAXIMUM_SHARDS	64
+#define NOT_QUEUED		-1
+#define NS_PER_SECOND	1000000000LL
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions*************/
+/*************  Global Variables  ***************/
+struct HOST_TIMER
+{
+	long long period;						//Period in nS, 0 = never initialized
+	long long periodStart;					//The expiry that was last served (or when the timer was started)
+	long long nextExpiry;					//Heap key
+	long long accountedThrough;				//Last expiry already counted as an overrun
+	long long pausedElapsed;				//Timer value held while the timer is off
+	void (*interruptFunction)(void);
+	int enabled;
+	int heapIndex;							//Position in the shard heap, NOT_QUEUED if not waiting to expire
+	int catchUpCalls;						//Back to back calls made so far under CATCH_UP_MISSED_PERIODS
+	enum TIMER_OVERRUN_POLICY overrunPolicy;
+	unsigned long overrunCount;
+	unsigned long droppedPeriods;
+	unsigned int pendingMissedPeriods;
+	unsigned int callMissedPeriods;
+} hostTimers[NUMBER_OF_AVAILABLE_TIMERS];
+
+struct TIMER_SHARD
+{
+	pthread_mutex_t lock;
+	pthread_t worker;
+	int timerFD;
+	int cpu;
+	int *heap;
+	int heapSize;
+} shards[MAXIMUM_SHARDS];
+
+int numberOfShards = 0;
+pthread_once_t shardsStarted = PTHREAD_ONCE_INIT;
+__thread int timerInService = -1;
+__thread long long expiryInService = -1;
+
+/*************Function  Prototypes***************/
+static void Start_Shards(void);
+static void *Shard_Worker(void *argument);
+static void Reschedule_After_Call(struct HOST_TIMER *timer, long long now);
+static void Arm_Shard(struct TIMER_SHARD *shard);
+static void Queue_Timer(struct TIMER_SHARD *shard, int timer);
+static void Dequeue_Timer(struct TIMER_SHARD *shard, int timer);
+static void Sift_Up(struct TIMER_SHARD *shard, int index);
+static void Sift_Down(struct TIMER_SHARD *shard, int index);
+static void Swap_Heap(struct TIMER_SHARD *shard, int a, int b);
+static long long Time_To_NS(int time, enum TIMER_UNITS units);
+static long long Now(void);
+
+/************* Device Definitions ***************/
+/************* Module Definitions ***************/
+/************* Other  Definitions ***************/
+#define SHARD_OF(timer)	(&shards[(timer) % numberOfShards])
+
+int Initialize_Timer(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS units, void (*interruptFunction)(void))
+{
+	struct TIMER_SHARD *shard;
+	long long period;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	period = Time_To_NS(time, units);
+	if(period <= 0)
+		return 0;//Out of range
+
+	pthread_once(&shardsStarted, Start_Shards);
+	shard = SHARD_OF(timer);
+
+	pthread_mutex_lock(&shard->lock);
+	Dequeue_Timer(shard, timer);
+
+	hostTimers[timer].period		= period;
+	hostTimers[timer].periodStart	= Now();
+	hostTimers[timer].nextExpiry	= hostTimers[timer].periodStart + period;
+	hostTimers[timer].enabled		= 1;
+	hostTimers[timer].catchUpCalls	= 0;
+
+	//Only setup the interrupts if we have a valid function pointer
+	if(interruptFunction)//Check for null pointer
+		hostTimers[timer].interruptFunction = interruptFunction;
+	if(hostTimers[timer].interruptFunction)
+		Queue_Timer(shard, timer);
+
+	Arm_Shard(shard);
+	pthread_mutex_unlock(&shard->lock);
+
+	//Success
+	return 1;
+}
+
+int Initialize_TMR3_As_Gated_Timer(int time, enum TIMER_UNITS units, int gateSource, int mode, int triggerPolarity, void (*interruptFunction)(void))
+{
+	return 0;//There is no gate input on the host, as such, this function call has failed
+}
+
+int Change_Timer_Trigger(enum TIMERS_AVAILABLE timer, int newState)
+{
+	struct TIMER_SHARD *shard;
+	struct HOST_TIMER *hostTimer;
+	long long now;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if((newState != TIMER_ON) && (newState != TIMER_OFF))
+		return 0;//Out of range
+
+	pthread_once(&shardsStarted, Start_Shards);
+	shard = SHARD_OF(timer);
+	hostTimer = &hostTimers[timer];
+
+	pthread_mutex_lock(&shard->lock);
+	now = Now();
+	if((newState == TIMER_OFF) && hostTimer->enabled)
+	{
+		//Hold the timer value where it is
+		hostTimer->pausedElapsed = 0;
+		if(hostTimer->period && (now > hostTimer->periodStart))
+			hostTimer->pausedElapsed = (now - hostTimer->periodStart) % hostTimer->period;
+		hostTimer->enabled = 0;
+		Dequeue_Timer(shard, timer);
+	}
+	else if((newState == TIMER_ON) && !hostTimer->enabled)
+	{
+		//Pick up where we left off
+		hostTimer->enabled = 1;
+		hostTimer->periodStart = now - hostTimer->pausedElapsed;
+		hostTimer->nextExpiry = hostTimer->periodStart + hostTimer->period;
+		if(hostTimer->period && hostTimer->interruptFunction)
+			Queue_Timer(shard, timer);
+	}
+	Arm_Shard(shard);
+	pthread_mutex_unlock(&shard->lock);
+
+	//Success
+	return 1;
+}
+
+int Current_Timer(enum TIMERS_AVAILABLE timer, enum TIMER_UNITS units)
+{
+	struct TIMER_SHARD *shard;
+	struct HOST_TIMER *hostTimer;
+	long long time = 0;
+	long long now;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	pthread_once(&shardsStarted, Start_Shards);
+	shard = SHARD_OF(timer);
+	hostTimer = &hostTimers[timer];
+
+	//Time since the last expiry, wrapped the same way the period register would
+	pthread_mutex_lock(&shard->lock);
+	now = Now();
+	if(hostTimer->period)
+	{
+		if(!hostTimer->enabled)
+			time = hostTimer->pausedElapsed;
+		else if(now > hostTimer->periodStart)
+			time = (now - hostTimer->periodStart) % hostTimer->period;
+	}
+	pthread_mutex_unlock(&shard->lock);
+
+	//Apply units modifier and return finished value
+	switch(units)
+	{
+		case SECONDS:
+			return (int)(time / NS_PER_SECOND);
+		case MILLI_SECONDS:
+			return (int)(time / 1000000);
+		case MICRO_SECONDS:
+			return (int)(time / 1000);
+		case NANO_SECONDS:
+		case TICKS://One tick is one nS on the host
+			return (int)time;
+		default:
+			return 0;//Invalid units
+	}
+}
+
+int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS units)
+{
+	struct TIMER_SHARD *shard;
+	struct HOST_TIMER *hostTimer;
+	long long period;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	period = Time_To_NS(time, units);
+	if(period <= 0)
+		return 0;//Out of range
+
+	pthread_once(&shardsStarted, Start_Shards);
+	shard = SHARD_OF(timer);
+	hostTimer = &hostTimers[timer];
+
+	//Keep the current period's start, only move where it ends
+	pthread_mutex_lock(&shard->lock);
+	hostTimer->period = period;
+	hostTimer->nextExpiry = hostTimer->periodStart + period;
+	if(hostTimer->heapIndex != NOT_QUEUED)
+	{
+		Sift_Up(shard, hostTimer->heapIndex);
+		Sift_Down(shard, hostTimer->heapIndex);
+		Arm_Shard(shard);
+	}
+	pthread_mutex_unlock(&shard->lock);
+
+	return 1;//Success
+}
+
+int Change_Timer_Overrun_Policy(enum TIMERS_AVAILABLE timer, enum TIMER_OVERRUN_POLICY policy)
+{
+	struct TIMER_SHARD *shard;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if((policy != SKIP_MISSED_PERIODS) && (policy != COALESCE_MISSED_PERIODS) && (policy != CATCH_UP_MISSED_PERIODS))
+		return 0;//Out of range
+
+	pthread_once(&shardsStarted, Start_Shards);
+	shard = SHARD_OF(timer);
+
+	//Make it official and start counting fresh
+	pthread_mutex_lock(&shard->lock);
+	hostTimers[timer].overrunPolicy			= policy;
+	hostTimers[timer].overrunCount			= 0;
+	hostTimers[timer].droppedPeriods		= 0;
+	hostTimers[timer].pendingMissedPeriods	= 0;
+	hostTimers[timer].callMissedPeriods		= 0;
+	hostTimers[timer].catchUpCalls			= 0;
+	pthread_mutex_unlock(&shard->lock);
+
+	//Success
+	return 1;
+}
+
+unsigned long Timer_Overruns(enum TIMERS_AVAILABLE timer)
+{
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	return __atomic_load_n(&hostTimers[timer].overrunCount, __ATOMIC_RELAXED);
+}
+
+unsigned long Timer_Dropped_Periods(enum TIMERS_AVAILABLE timer)
+{
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	return __atomic_load_n(&hostTimers[timer].droppedPeriods, __ATOMIC_RELAXED);
+}
+
+unsigned int Timer_Missed_Periods(enum TIMERS_AVAILABLE timer)
+{
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	return __atomic_load_n(&hostTimers[timer].callMissedPeriods, __ATOMIC_RELAXED);
+}
+
+int Timer_In_Service(void)
+{
+	return timerInService;
+}
+
+long long Timer_Expiry_In_Service(void)
+{
+	return expiryInService;
+}
+
+static void Start_Shards(void)
+{
+	cpu_set_t available;
+	int timer;
+	int shard;
+	int cpu;
+
+	//One shard per core we are allowed to run on
+	CPU_ZERO(&available);
+	if(sched_getaffinity(0, sizeof(available), &available) == 0)
+		numberOfShards = CPU_COUNT(&available);
+	if(numberOfShards < 1)
+		numberOfShards = 1;
+	if(numberOfShards > MAXIMUM_SHARDS)
+		numberOfShards = MAXIMUM_SHARDS;
+	if(numberOfShards > NUMBER_OF_AVAILABLE_TIMERS)
+		numberOfShards = NUMBER_OF_AVAILABLE_TIMERS;
+
+	for(timer = 0; timer < NUMBER_OF_AVAILABLE_TIMERS; timer++)
+		hostTimers[timer].heapIndex = NOT_QUEUED;
+
+	for(shard = 0, cpu = 0; shard < numberOfShards; shard++, cpu++)
+	{
+		//Find the next core this process may use
+		while((cpu < CPU_SETSIZE) && !CPU_ISSET(cpu, &available))
+			cpu++;
+		shards[shard].cpu = (cpu < CPU_SETSIZE) ? cpu : -1;
+
+		pthread_mutex_init(&shards[shard].lock, NULL);
+		shards[shard].heap = malloc(sizeof(int) * (NUMBER_OF_AVAILABLE_TIMERS / numberOfShards + 1));
+		shards[shard].heapSize = 0;
+		shards[shard].timerFD = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if((shards[shard].heap == NULL) || (shards[shard].timerFD < 0))
+			abort();//Nothing sensible can be done without these
+		if(pthread_create(&shards[shard].worker, NULL, Shard_Worker, &shards[shard]) != 0)
+			abort();//Every timer in this shard would silently never expire
+	}
+
+	return;
+}
+
+static void *Shard_Worker(void *argument)
+{
+	struct TIMER_SHARD *shard = argument;
+	struct HOST_TIMER *hostTimer;
+	void (*interruptFunction)(void);
+	uint64_t expirations;
+	cpu_set_t core;
+	int timer;
+
+	//Stay on our own core so each shard's heap stays in one cache
+	if(shard->cpu >= 0)
+	{
+		CPU_ZERO(&core);
+		CPU_SET(shard->cpu, &core);
+		pthread_setaffinity_np(pthread_self(), sizeof(core), &core);
+	}
+
+	while(1)
+	{
+		//Sleep until the earliest expiry in this shard
+		if(read(shard->timerFD, &expirations, sizeof(expirations)) < 0)
+			if(errno != EAGAIN)
+				continue;//Interrupted, try again
+
+		pthread_mutex_lock(&shard->lock);
+		while(shard->heapSize && (hostTimers[shard->heap[0]].nextExpiry <= Now()))
+		{
+			timer = shard->heap[0];
+			hostTimer = &hostTimers[timer];
+			Dequeue_Timer(shard, timer);
+
+			//This expiry is now being served
+			hostTimer->periodStart = hostTimer->nextExpiry;
+			hostTimer->callMissedPeriods = hostTimer->pendingMissedPeriods;
+			hostTimer->pendingMissedPeriods = 0;
+			interruptFunction = hostTimer->interruptFunction;
+
+			//Run the associated function without holding the shard, it may want to change its own timer
+			//The rest of the shard waits for it to finish, just like lower priority interrupts wait on the chip
+			pthread_mutex_unlock(&shard->lock);
+			timerInService = timer;
+			expiryInService = hostTimer->periodStart;
+			interruptFunction();
+			timerInService = -1;
+			expiryInService = -1;
+			pthread_mutex_lock(&shard->lock);
+
+			//If the timer was changed while the function was running, it has already been queued (or stopped)
+			if((hostTimer->heapIndex == NOT_QUEUED) && hostTimer->enabled)
+			{
+				Reschedule_After_Call(hostTimer, Now());
+				Queue_Timer(shard, timer);
+			}
+		}
+		Arm_Shard(shard);
+		pthread_mutex_unlock(&shard->lock);
+	}
+
+	return NULL;
+}
+
+static void Reschedule_After_Call(struct HOST_TIMER *hostTimer, long long now)
+{
+	long long missed;
+	long long counted;
+
+	//Every expiry after the one just served, up to now, was missed
+	missed = 0;
+	if(now >= hostTimer->periodStart + hostTimer->period)
+		missed = (now - hostTimer->periodStart) / hostTimer->period;
+
+	//Count each expiry as an overrun only once, catching up visits the same expiries more than once
+	counted = 0;
+	if(hostTimer->accountedThrough > hostTimer->periodStart)
+		counted = (hostTimer->accountedThrough - hostTimer->periodStart) / hostTimer->period;
+	if(missed > counted)
+	{
+		hostTimer->overrunCount += missed - counted;
+		if(hostTimer->overrunCount > 0xFFFFFFFF)
+			hostTimer->overrunCount = 0xFFFFFFFF;
+		hostTimer->accountedThrough = hostTimer->periodStart + missed * hostTimer->period;
+	}
+
+	if(missed == 0)
+	{
+		//Finished in time
+		hostTimer->catchUpCalls = 0;
+		hostTimer->nextExpiry = hostTimer->periodStart + hostTimer->period;
+		return;
+	}
+
+	switch(hostTimer->overrunPolicy)
+	{
+		case COALESCE_MISSED_PERIODS:
+			hostTimer->pendingMissedPeriods = (hostTimer->pendingMissedPeriods + missed > 0xFFFF) ? 0xFFFF : hostTimer->pendingMissedPeriods + missed;
+			break;
+		case CATCH_UP_MISSED_PERIODS:
+			if(++hostTimer->catchUpCalls < TIMER_CATCH_UP_LIMIT)
+			{
+				hostTimer->nextExpiry = hostTimer->periodStart + hostTimer->period;//Already due, run it again straight away
+				return;
+			}
+			//Too far behind, keep the loop bounded and drop the rest
+		case SKIP_MISSED_PERIODS:
+		default:
+			hostTimer->droppedPeriods += missed;
+			if(hostTimer->droppedPeriods > 0xFFFFFFFF)
+				hostTimer->droppedPeriods = 0xFFFFFFFF;
+			break;
+	}
+
+	//Line back up with the next expiry that is still in the future
+	hostTimer->catchUpCalls = 0;
+	hostTimer->periodStart += missed * hostTimer->period;
+	hostTimer->nextExpiry = hostTimer->periodStart + hostTimer->period;
+
+	return;
+}
+
+static void Arm_Shard(struct TIMER_SHARD *shard)
+{
+	struct itimerspec expiry = {{0, 0}, {0, 0}};
+
+	//Arm for the earliest expiry, or disarm if nothing is waiting
+	if(shard->heapSize)
+	{
+		expiry.it_value.tv_sec = hostTimers[shard->heap[0]].nextExpiry / NS_PER_SECOND;
+		expiry.it_value.tv_nsec = hostTimers[shard->heap[0]].nextExpiry % NS_PER_SECOND;
+		if((expiry.it_value.tv_sec == 0) && (expiry.it_value.tv_nsec == 0))
+			expiry.it_value.tv_nsec = 1;//Zero would disarm it
+	}
+	timerfd_settime(shard->timerFD, TFD_TIMER_ABSTIME, &expiry, NULL);
+
+	return;
+}
+
+static void Queue_Timer(struct TIMER_SHARD *shard, int timer)
+{
+	if(hostTimers[timer].heapIndex != NOT_QUEUED)
+		return;//Already waiting
+
+	hostTimers[timer].heapIndex = shard->heapSize;
+	shard->heap[shard->heapSize++] = timer;
+	Sift_Up(shard, hostTimers[timer].heapIndex);
+
+	return;
+}
+
+static void Dequeue_Timer(struct TIMER_SHARD *shard, int timer)
+{
+	int index = hostTimers[timer].heapIndex;
+
+	if(index == NOT_QUEUED)
+		return;//Not waiting
+
+	//Move the last entry into the hole and let it find its place
+	Swap_Heap(shard, index, --shard->heapSize);
+	hostTimers[timer].heapIndex = NOT_QUEUED;
+	if(index < shard->heapSize)
+	{
+		Sift_Up(shard, index);
+		Sift_Down(shard, index);
+	}
+
+	return;
+}
+
+static void Sift_Up(struct TIMER_SHARD *shard, int index)
+{
+	int parent;
+
+	while(index > 0)
+	{
+		parent = (index - 1) / 2;
+		if(hostTimers[shard->heap[parent]].nextExpiry <= hostTimers[shard->heap[index]].nextExpiry)
+			return;
+		Swap_Heap(shard, parent, index);
+		index = parent;
+	}
+
+	return;
+}
+
+static void Sift_Down(struct TIMER_SHARD *shard, int index)
+{
+	int child;
+
+	while((child = 2 * index + 1) < shard->heapSize)
+	{
+		if((child + 1 < shard->heapSize) && (hostTimers[shard->heap[child + 1]].nextExpiry < hostTimers[shard->heap[child]].nextExpiry))
+			child++;
+		if(hostTimers[shard->heap[index]].nextExpiry <= hostTimers[shard->heap[child]].nextExpiry)
+			return;
+		Swap_Heap(shard, index, child);
+		index = child;
+	}
+
+	return;
+}
+
+static void Swap_Heap(struct TIMER_SHARD *shard, int a, int b)
+{
+	int timer = shard->heap[a];
+
+	shard->heap[a] = shard->heap[b];
+	shard->heap[b] = timer;
+	hostTimers[shard->heap[a]].heapIndex = a;
+	hostTimers[shard->heap[b]].heapIndex = b;
+
+	return;
+}
+
+static long long Time_To_NS(int time, enum TIMER_UNITS units)
+{
+	//Determine the target time in nS
+	switch(units)
+	{
+		case SECONDS:
+			return time * NS_PER_SECOND;
+		case MILLI_SECONDS:
+			return time * 1000000LL;
+		case MICRO_SECONDS:
+			return time * 1000LL;
+		case NANO_SECONDS:
+		case TICKS://One tick is one nS on the host
+			return time;
+		default:
+			return 0;//Invalid units
+	}
+}
+
+static long long Now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * NS_PER_SECOND + now.tv_nsec;
+}
@@ -0,0 +1,427 @@
+/**************************************************************************************************
+Authours:				Craig Comberbach
+Target Hardware:		Linux host (regression testing)
+Chip resources used:	None, time only moves when Advance_Virtual_Time or Step_Virtual_Time is called
+Code assumptions:		Compiled in place of Timers.c with TIMERS_VIRTUAL_TIME defined
+						Single threaded, timer functions run on the thread that advances time
+Purpose:				Discrete event version of the Timers.h API. Every configured timer's next period match sits in one global min-heap, time
+						jumps straight to the earliest match and the functions are called in exact tick order (ties go to the lowest timer)
+
+Version History:
+v0.2.0	2026-10-19  Craig Comberbach
+	Added Timer Expiry In Service to match the POSIX backend
+v0.1.0	2026-10-19  Craig Comberbach
+	Initialize Timer, Change Timer Time, Current Timer and Change Timer Trigger are implemented against a virtual clock
+	Added Advance Virtual Time, Step Virtual Time and Virtual Time so tests can drive the clock
+**************************************************************************************************/
+/*************    Header Files    ***************/
+#include "Timers.h"
+
+/************* Semantic Versioning***************/
+/************Arbitrary Functionality*************/
+/*************   Magic  Numbers   ***************/
+#define NOT_QUEUED		-1
+#define NS_PER_SECOND	1000000000LL
+
+/*************    Enumeration     ***************/
+/***********State Machine Definitions*************/
+/*************  Global Variables  ***************/
+struct VIRTUAL_TIMER
+{
+	long long period;					//Period in nS, 0 = never initialized
+	long long periodStart;				//Time of the last period match (or when the timer was started)
+	long long nextExpiry;				//Heap key
+	long long pausedElapsed;			//Timer value held while the timer is off
+	void (*interruptFunction)(void);
+	int enabled;
+	int heapIndex;						//Position in the event heap, NOT_QUEUED if not waiting to expire
+	enum TIMER_OVERRUN_POLICY overrunPolicy;
+} virtualTimers[NUMBER_OF_AVAILABLE_TIMERS];
+
+int eventHeap[NUMBER_OF_AVAILABLE_TIMERS];
+int eventHeapSize = 0;
+int heapInitialized = 0;
+long long virtualNow = 0;
+int timerInService = -1;
+
+/*************Function  Prototypes***************/
+static void Initialize_Heap(void);
+static void Fire_Next_Event(void);
+static void Queue_Timer(int timer);
+static void Dequeue_Timer(int timer);
+static int Earlier(int a, int b);
+static void Sift_Up(int index);
+static void Sift_Down(int index);
+static void Swap_Heap(int a, int b);
+static long long Time_To_NS(int time, enum TIMER_UNITS units);
+
+/************* Device Definitions ***************/
+/************* Module Definitions ***************/
+/************* Other  Definitions ***************/
+
+int Initialize_Timer(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS units, void (*interruptFunction)(void))
+{
+	long long period;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	period = Time_To_NS(time, units);
+	if(period <= 0)
+		return 0;//Out of range
+
+	Initialize_Heap();
+	Dequeue_Timer(timer);
+
+	virtualTimers[timer].period			= period;
+	virtualTimers[timer].periodStart	= virtualNow;
+	virtualTimers[timer].nextExpiry		= virtualNow + period;
+	virtualTimers[timer].enabled		= 1;
+
+	//Only setup the interrupts if we have a valid function pointer
+	if(interruptFunction)//Check for null pointer
+		virtualTimers[timer].interruptFunction = interruptFunction;
+	if(virtualTimers[timer].interruptFunction)
+		Queue_Timer(timer);
+
+	//Success
+	return 1;
+}
+
+int Initialize_TMR3_As_Gated_Timer(int time, enum TIMER_UNITS units, int gateSource, int mode, int triggerPolarity, void (*interruptFunction)(void))
+{
+	return 0;//There is no gate input in the simulation, as such, this function call has failed
+}
+
+int Change_Timer_Trigger(enum TIMERS_AVAILABLE timer, int newState)
+{
+	struct VIRTUAL_TIMER *virtualTimer;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if((newState != TIMER_ON) && (newState != TIMER_OFF))
+		return 0;//Out of range
+
+	Initialize_Heap();
+	virtualTimer = &virtualTimers[timer];
+
+	if((newState == TIMER_OFF) && virtualTimer->enabled)
+	{
+		//Hold the timer value where it is
+		virtualTimer->pausedElapsed = 0;
+		if(virtualTimer->period)
+			virtualTimer->pausedElapsed = (virtualNow - virtualTimer->periodStart) % virtualTimer->period;
+		virtualTimer->enabled = 0;
+		Dequeue_Timer(timer);
+	}
+	else if((newState == TIMER_ON) && !virtualTimer->enabled)
+	{
+		//Pick up where we left off
+		virtualTimer->enabled = 1;
+		virtualTimer->periodStart = virtualNow - virtualTimer->pausedElapsed;
+		virtualTimer->nextExpiry = virtualTimer->periodStart + virtualTimer->period;
+		if(virtualTimer->period && virtualTimer->interruptFunction)
+			Queue_Timer(timer);
+	}
+
+	//Success
+	return 1;
+}
+
+int Current_Timer(enum TIMERS_AVAILABLE timer, enum TIMER_UNITS units)
+{
+	struct VIRTUAL_TIMER *virtualTimer;
+	long long time = 0;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+
+	//Simulated count since the last period match
+	virtualTimer = &virtualTimers[timer];
+	if(virtualTimer->period)
+	{
+		if(!virtualTimer->enabled)
+			time = virtualTimer->pausedElapsed;
+		else
+			time = (virtualNow - virtualTimer->periodStart) % virtualTimer->period;
+	}
+
+	//Apply units modifier and return finished value
+	switch(units)
+	{
+		case SECONDS:
+			return (int)(time / NS_PER_SECOND);
+		case MILLI_SECONDS:
+			return (int)(time / 1000000);
+		case MICRO_SECONDS:
+			return (int)(time / 1000);
+		case NANO_SECONDS:
+		case TICKS://One tick is one nS in the simulation
+			return (int)time;
+		default:
+			return 0;//Invalid units
+	}
+}
+
+int Change_Timer_Time(enum TIMERS_AVAILABLE timer, int time, enum TIMER_UNITS units)
+{
+	struct VIRTUAL_TIMER *virtualTimer;
+	long long period;
+
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	period = Time_To_NS(time, units);
+	if(period <= 0)
+		return 0;//Out of range
+
+	Initialize_Heap();
+	virtualTimer = &virtualTimers[timer];
+
+	//Keep the current period's start, only move where it ends (but never into the past)
+	virtualTimer->period = period;
+	virtualTimer->nextExpiry = virtualTimer->periodStart + period;
+	if(virtualTimer->nextExpiry < virtualNow)
+		virtualTimer->nextExpiry = virtualNow;
+	if(virtualTimer->heapIndex != NOT_QUEUED)
+	{
+		Sift_Up(virtualTimer->heapIndex);
+		Sift_Down(virtualTimer->heapIndex);
+	}
+
+	return 1;//Success
+}
+
+int Change_Timer_Overrun_Policy(enum TIMERS_AVAILABLE timer, enum TIMER_OVERRUN_POLICY policy)
+{
+	//Range check
+	if((timer < 0 ) || (timer >= NUMBER_OF_AVAILABLE_TIMERS))
+		return 0;//Out of range
+	if((policy != SKIP_MISSED_PERIODS) && (policy != COALESCE_MISSED_PERIODS) && (policy != CATCH_UP_MISSED_PERIODS))
+		return 0;//Out of range
+
+	//Functions take no virtual time, so the policy is only kept for API compatibility
+	virtualTimers[timer].overrunPolicy = policy;
+
+	//Success
+	return 1;
+}
+
+unsigned long Timer_Overruns(enum TIMERS_AVAILABLE timer)
+{
+	return 0;//Functions take no virtual time, a timer can not overrun
+}
+
+unsigned long Timer_Dropped_Periods(enum TIMERS_AVAILABLE timer)
+{
+	return 0;//Functions take no virtual time, a period is never dropped
+}
+
+unsigned int Timer_Missed_Periods(enum TIMERS_AVAILABLE timer)
+{
+	return 0;//Functions take no virtual time, a period is never missed
+}
+
+int Timer_In_Service(void)
+{
+	return timerInService;
+}
+
+long long Timer_Expiry_In_Service(void)
+{
+	if(timerInService == -1)
+		return -1;//Not running a timer function
+	return virtualNow;//Functions take no virtual time, every call is right on its expiry
+}
+
+int Advance_Virtual_Time(int time, enum TIMER_UNITS units)
+{
+	long long target;
+
+	//Range check
+	if(timerInService != -1)
+		return 0;//Time can not be moved from inside a timer function
+	if(time < 0)
+		return 0;//Out of range
+	target = virtualNow + Time_To_NS(time, units);
+	if((target < virtualNow) || ((time != 0) && (target == virtualNow)))
+		return 0;//Out of range or invalid units
+
+	Initialize_Heap();
+
+	//Jump from match to match until the target is reached
+	while(eventHeapSize && (virtualTimers[eventHeap[0]].nextExpiry <= target))
+		Fire_Next_Event();
+	virtualNow = target;
+
+	//Success
+	return 1;
+}
+
+int Step_Virtual_Time(void)
+{
+	long long matchTime;
+
+	//Range check
+	if(timerInService != -1)
+		return 0;//Time can not be moved from inside a timer function
+
+	Initialize_Heap();
+	if(eventHeapSize == 0)
+		return 0;//Nothing is going to happen
+
+	//Fire everything that matches at the next instant
+	matchTime = virtualTimers[eventHeap[0]].nextExpiry;
+	while(eventHeapSize && (virtualTimers[eventHeap[0]].nextExpiry == matchTime))
+		Fire_Next_Event();
+
+	//Success
+	return 1;
+}
+
+long long Virtual_Time(void)
+{
+	return virtualNow;
+}
+
+static void Fire_Next_Event(void)
+{
+	struct VIRTUAL_TIMER *virtualTimer;
+	int timer;
+
+	timer = eventHeap[0];
+	virtualTimer = &virtualTimers[timer];
+	Dequeue_Timer(timer);
+
+	//Move the clock to the match and line the timer up for its next one before running
+	virtualNow = virtualTimer->nextExpiry;
+	virtualTimer->periodStart = virtualNow;
+	virtualTimer->nextExpiry = virtualNow + virtualTimer->period;
+	Queue_Timer(timer);
+
+	//Run the associated function, it is free to change or stop any timer including its own
+	timerInService = timer;
+	virtualTimer->interruptFunction();
+	timerInService = -1;
+
+	return;
+}
+
+static void Initialize_Heap(void)
+{
+	int timer;
+
+	if(heapInitialized)
+		return;
+
+	for(timer = 0; timer < NUMBER_OF_AVAILABLE_TIMERS; timer++)
+		virtualTimers[timer].heapIndex = NOT_QUEUED;
+	heapInitialized = 1;
+
+	return;
+}
+
+static void Queue_Timer(int timer)
+{
+	if(virtualTimers[timer].heapIndex != NOT_QUEUED)
+		return;//Already waiting
+
+	virtualTimers[timer].heapIndex = eventHeapSize;
+	eventHeap[eventHeapSize++] = timer;
+	Sift_Up(virtualTimers[timer].heapIndex);
+
+	return;
+}
+
+static void Dequeue_Timer(int timer)
+{
+	int index = virtualTimers[timer].heapIndex;
+
+	if(index == NOT_QUEUED)
+		return;//Not waiting
+
+	//Move the last entry into the hole and let it find its place
+	Swap_Heap(index, --eventHeapSize);
+	virtualTimers[timer].heapIndex = NOT_QUEUED;
+	if(index < eventHeapSize)
+	{
+		Sift_Up(index);
+		Sift_Down(index);
+	}
+
+	return;
+}
+
+static int Earlier(int a, int b)
+{
+	//Ties go to the lowest timer so every run fires in the same order
+	if(virtualTimers[eventHeap[a]].nextExpiry != virtualTimers[eventHeap[b]].nextExpiry)
+		return virtualTimers[eventHeap[a]].nextExpiry < virtualTimers[eventHeap[b]].nextExpiry;
+	return eventHeap[a] < eventHeap[b];
+}
+
+static void Sift_Up(int index)
+{
+	int parent;
+
+	while(index > 0)
+	{
+		parent = (index - 1) / 2;
+		if(!Earlier(index, parent))
+			return;
+		Swap_Heap(parent, index);
+		index = parent;
+	}
+
+	return;
+}
+
+static void Sift_Down(int index)
+{
+	int child;
+
+	while((child = 2 * index + 1) < eventHeapSize)
+	{
+		if((child + 1 < eventHeapSize) && Earlier(child + 1, child))
+			child++;
+		if(!Earlier(child, index))
+			return;
+		Swap_Heap(index, child);
+		index = child;
+	}
+
+	return;
+}
+
+static void Swap_Heap(int a, int b)
+{
+	int timer = eventHeap[a];
+
+	eventHeap[a] = eventHeap[b];
+	eventHeap[b] = timer;
+	virtualTimers[eventHeap[a]].heapIndex = a;
+	virtualTimers[eventHeap[b]].heapIndex = b;
+
+	return;
+}
+
+static long long Time_To_NS(int time, enum TIMER_UNITS units)
+{
+	//Determine the target time in nS
+	switch(units)
+	{
+		case SECONDS:
+			return time * NS_PER_SECOND;
+		case MILLI_SECONDS:
+			return time * 1000000LL;
+		case MICRO_SECONDS:
+			return time * 1000LL;
+		case NANO_SECONDS:
+		case TICKS://One tick is one nS in the simulation
+			return time;
+		default:
+			return 0;//Invalid units
+	}
+}